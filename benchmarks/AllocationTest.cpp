@@ -0,0 +1,92 @@
+/**
+ * @file    AllocationTest.cpp
+ * @brief   Test that a Log does not allocate any memory in steady state, counting the calls to operator new
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <LoggerCpp/LoggerCpp.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+
+/// Number of calls to any operator new since the start of the program
+static std::atomic<unsigned long> sNbAllocations(0);
+
+void* operator new(std::size_t aSize) {
+    ++sNbAllocations;
+    void* pMemory = std::malloc(aSize ? aSize : 1);
+    if (nullptr == pMemory) {
+        throw std::bad_alloc();
+    }
+    return pMemory;
+}
+
+void* operator new[](std::size_t aSize) {
+    return operator new(aSize);
+}
+
+void operator delete(void* apMemory) noexcept {
+    std::free(apMemory);
+}
+
+void operator delete[](void* apMemory) noexcept {
+    std::free(apMemory);
+}
+
+void operator delete(void* apMemory, std::size_t) noexcept {
+    std::free(apMemory);
+}
+
+void operator delete[](void* apMemory, std::size_t) noexcept {
+    std::free(apMemory);
+}
+
+
+/// Output a mix of streamed and formatted Log of the usual kinds of arguments
+static void outputLogs(const Log::Logger& aLogger, const std::string& aString, int aNbLogs) {
+    for (int i = 0; i < aNbLogs; ++i) {
+        aLogger.info() << "stream; int=" << i << " double=" << (i * 0.25) << " string=" << aString;
+        aLogger.notice("format; int={} double={:.3f} string={}", i, i * 0.25, aString);
+        LOG_WARNING(aLogger) << "macro; pointer=" << &aString << " hex=" << std::hex << i;
+    }
+}
+
+/**
+ * @brief Output Log to a file, then count the allocations of the same Log once the buffers have grown
+ *
+ * @return 0 if no Log allocated any memory, 1 otherwise
+ */
+int main() {
+    Log::Config::Vector configList;
+    Log::Config::addOutput(configList, "OutputFile");
+    Log::Config::setOption(configList, "filename",      "/dev/null");
+    Log::Config::setOption(configList, "filename_old",  "/dev/null");
+    Log::Config::setOption(configList, "max_size",      "2000000000");
+    Log::Manager::configure(configList);
+
+    const Log::Logger   logger("Allocation.Test");
+    const std::string   str("a string longer than the small string optimization of the std::string");
+
+    // Warm up: let the thread buffers, the thread header and the file buffer grow to their steady size
+    outputLogs(logger, str, 1000);
+
+    const int           nbLogs  = 10000;
+    const unsigned long before  = sNbAllocations;
+    outputLogs(logger, str, nbLogs);
+    const unsigned long after   = sNbAllocations;
+
+    Log::Manager::terminate();
+
+    const unsigned long nbAllocations = after - before;
+    printf("%lu allocations for %d Log (%.3f per Log)\n", nbAllocations, 3 * nbLogs,
+           static_cast<double>(nbAllocations) / (3 * nbLogs));
+    return (0 == nbAllocations) ? 0 : 1;
+}
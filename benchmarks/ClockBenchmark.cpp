@@ -0,0 +1,57 @@
+/**
+ * @file    ClockBenchmark.cpp
+ * @brief   Benchmark of the capture cost of the timestamps of each source of the Clock, in nanoseconds
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <LoggerCpp/Clock.h>
+
+#include <chrono>
+#include <cstdio>
+
+
+/// Number of iterations of each measure
+static const long NB_ITERATIONS = 10000000;
+
+/// Written by each iteration, so that the loops are not optimized out
+static volatile long long sSink = 0;
+
+/// Run the lambda NB_ITERATIONS times, and return the time of one iteration in nanoseconds
+template <typename Lambda>
+static double measure(Lambda aLambda) {
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (long i = 0; i < NB_ITERATIONS; ++i) {
+        sSink = aLambda();
+    }
+    const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / NB_ITERATIONS;
+}
+
+/**
+ * @brief Measure the capture of a stamp by the Log (Clock::now()), and its later conversion to the wall clock
+ *
+ * @param[in] apSource  Name of the source of the stamps
+ */
+static void measureSource(const char* apSource) {
+    Log::Clock::setSource(Log::Clock::toSource(apSource));
+    const double capture = measure([]() { return Log::Clock::now(); });
+    const long long stamp = Log::Clock::now();
+    const double conversion = measure([stamp]() { return Log::Clock::toEpochNano(stamp); });
+    printf("%-13s capture %6.2f ns/stamp, conversion to the wall clock %6.2f ns/stamp%s\n",
+           apSource, capture, conversion,
+           (Log::Clock::toSource(apSource) != Log::Clock::getSource()) ? " (fell back to monotonic_raw)" : "");
+}
+
+/**
+ * @brief Measure the capture cost of each source of the stamps
+ */
+int main() {
+    measureSource("realtime");
+    measureSource("monotonic_raw");
+    measureSource("tsc");
+    return 0;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file    ClockTest.cpp
+ * @brief   Test of the drift of the raw timestamps of the Clock, converted to the wall clock over several seconds
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <LoggerCpp/Clock.h>
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+
+/// Duration of the test of each source, in milliseconds: several synchronizations with the wall clock
+static const int DURATION = 3000;
+
+/// Period of the samples, in milliseconds
+static const int PERIOD = 50;
+
+/// Maximum error allowed between a converted stamp and the wall clock, in nanoseconds
+static const long long TOLERANCE = 1000000;
+
+/**
+ * @brief Compare the stamps of a source converted to the wall clock with the wall clock itself
+ *
+ * @param[in] apSource  Name of the source of the stamps
+ *
+ * @return true if the error of each stamp stayed within the tolerance
+ */
+static bool testSource(const char* apSource) {
+    Log::Clock::setSource(Log::Clock::toSource(apSource));
+
+    long long maxDrift = 0;
+    long long maxError = 0;
+    for (int elapsed = 0; elapsed < DURATION; elapsed += PERIOD) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(PERIOD));
+
+        // The stamp is captured between two readings of the wall clock: the drift is measured from their middle,
+        // and the error outside of them (so that a preemption between the readings does not fail the test)
+        const long long before  = Log::Clock::getRealtime();
+        const long long stamp   = Log::Clock::now();
+        const long long after   = Log::Clock::getRealtime();
+        const long long nano    = Log::Clock::toEpochNano(stamp);
+        const long long drift   = nano - (before + (after - before) / 2);
+        const long long error   = (nano < before) ? (before - nano) : ((nano > after) ? (nano - after) : 0);
+        if (maxDrift < ((drift < 0) ? -drift : drift)) {
+            maxDrift = (drift < 0) ? -drift : drift;
+        }
+        if (maxError < error) {
+            maxError = error;
+        }
+    }
+
+    const bool bSuccess = (maxError <= TOLERANCE);
+    printf("%-13s maximum drift %8.3f us, error %8.3f us over %d ms%s%s\n", apSource,
+           static_cast<double>(maxDrift) / 1000, static_cast<double>(maxError) / 1000, DURATION,
+           (Log::Clock::toSource(apSource) != Log::Clock::getSource()) ? " (fell back to monotonic_raw)" : "",
+           bSuccess ? "" : ": FAILED");
+    return bSuccess;
+}
+
+/**
+ * @brief Test the drift of each source of the stamps
+ *
+ * @return 0 if no converted stamp drifted from the wall clock more than the tolerance, 1 otherwise
+ */
+int main() {
+    bool bSuccess = testSource("realtime");
+    bSuccess = testSource("monotonic_raw") && bSuccess;
+    bSuccess = testSource("tsc") && bSuccess;
+    return bSuccess ? 0 : 1;
+}
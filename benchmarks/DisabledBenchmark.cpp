@@ -0,0 +1,76 @@
+/**
+ * @file    DisabledBenchmark.cpp
+ * @brief   Benchmark of the cost of a disabled Log statement, with and without the LOG_xxx() macros
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <LoggerCpp/LoggerCpp.h>
+
+#include <chrono>
+#include <cstdio>
+
+
+/// Number of iterations of each measure
+static const long NB_ITERATIONS = 100000000;
+
+/// Written by each iteration, so that the loops are not optimized out
+static volatile long sSink = 0;
+
+/// Number of evaluations of the operand of the Log statements
+static volatile long sNbEvaluations = 0;
+
+/// An operand that is costly to evaluate, which should not be evaluated by a disabled Log statement
+static long expensive(long aValue) {
+    ++sNbEvaluations;
+    return aValue * 3;
+}
+
+/// Run the Log statement of the lambda NB_ITERATIONS times, and return the time of one iteration in nanoseconds
+template <typename Lambda>
+static double measure(Lambda aLambda) {
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (long i = 0; i < NB_ITERATIONS; ++i) {
+        aLambda(i);
+        sSink = i;
+    }
+    const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / NB_ITERATIONS;
+}
+
+/// Print the time of the Log statement compared to the empty loop, and the number of evaluations of its operand
+static void print(const char* apName, double aNano, double aBaseline) {
+    printf("%-40s %6.2f ns/statement (%+6.2f ns over the empty loop), %ld evaluations\n",
+           apName, aNano, aNano - aBaseline, static_cast<long>(sNbEvaluations));
+    sNbEvaluations = 0;
+}
+
+/**
+ * @brief Measure the disabled Debug statements of a Logger at the Notice Level
+ */
+int main() {
+    Log::Config::Vector configList;
+    Log::Config::addOutput(configList, "OutputFile");
+    Log::Config::setOption(configList, "filename",      "/dev/null");
+    Log::Config::setOption(configList, "filename_old",  "/dev/null");
+    Log::Manager::configure(configList);
+
+    Log::Logger logger("Disabled.Benchmark");
+    logger.setLevel(Log::Log::eNotice);
+
+    const double baseline = measure([](long) {});
+    print("empty loop", baseline, baseline);
+
+    print("LOG_DEBUG(logger) << expensive()",
+          measure([&logger](long i) { LOG_DEBUG(logger) << "value=" << expensive(i); }), baseline);
+    print("LOGF_DEBUG(logger, \"{}\", expensive())",
+          measure([&logger](long i) { LOGF_DEBUG(logger, "value={}", expensive(i)); }), baseline);
+    print("logger.debug() << expensive()",
+          measure([&logger](long i) { logger.debug() << "value=" << expensive(i); }), baseline);
+
+    Log::Manager::terminate();
+    return 0;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file    FormatBenchmark.cpp
+ * @brief   Benchmark of the "{}" format strings of the Logger against the stream path of the Log
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <LoggerCpp/LoggerCpp.h>
+
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+
+
+/// Number of Log output by each measure
+static const long NB_LOGS = 1000000;
+
+/// Output the Log of the lambda NB_LOGS times, and return the time of one Log in nanoseconds
+template <typename Lambda>
+static double measure(Lambda aLambda) {
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (long i = 0; i < NB_LOGS; ++i) {
+        aLambda(i);
+    }
+    const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / NB_LOGS;
+}
+
+/// Print the time of the stream path and of the format string for the same Log
+static void print(const char* apName, double aStreamNano, double aFormatNano) {
+    printf("  %-32s stream %7.1f ns/Log, format %7.1f ns/Log (x%.2f)\n",
+           apName, aStreamNano, aFormatNano, aStreamNano / aFormatNano);
+}
+
+/// Compare the stream path and the format strings for some usual kinds of Log
+static void compare(const Log::Logger& aLogger) {
+    print("integer and fixed double",
+          measure([&aLogger](long i) {
+              aLogger.info() << "user=" << i << " latency=" << std::fixed << std::setprecision(3) << (i * 0.001)
+                             << "ms";
+          }),
+          measure([&aLogger](long i) { aLogger.info("user={} latency={:.3f}ms", i, i * 0.001); }));
+    print("hexadecimal with width and fill",
+          measure([&aLogger](long i) {
+              aLogger.info() << "address=" << std::hex << std::setw(8) << std::setfill('0') << i;
+          }),
+          measure([&aLogger](long i) { aLogger.info("address={:08x}", i); }));
+    print("string and double",
+          measure([&aLogger](long i) { aLogger.info() << "name=" << "benchmark" << " value=" << (i * 0.25); }),
+          measure([&aLogger](long i) { aLogger.info("name={} value={}", "benchmark", i * 0.25); }));
+    print("LOG_INFO() and LOGF_INFO()",
+          measure([&aLogger](long i) { LOG_INFO(aLogger) << "user=" << i << " count=" << (i / 3); }),
+          measure([&aLogger](long i) { LOGF_INFO(aLogger, "user={} count={}", i, i / 3); }));
+}
+
+/**
+ * @brief Compare the formatting alone (no Output), then the whole Log output to a buffered file
+ */
+int main() {
+    const Log::Logger logger("Format.Benchmark");
+
+    Log::Config::Vector configList;
+    Log::Manager::configure(configList);
+    printf("No Output (formatting only):\n");
+    compare(logger);
+
+    Log::Config::addOutput(configList, "OutputFile");
+    Log::Config::setOption(configList, "filename",      "/dev/null");
+    Log::Config::setOption(configList, "filename_old",  "/dev/null");
+    Log::Config::setOption(configList, "max_size",      "2000000000");
+    Log::Config::setOption(configList, "flush_size",    "65536");
+    Log::Manager::configure(configList);
+    printf("OutputFile (buffered, to /dev/null):\n");
+    compare(logger);
+
+    Log::Manager::terminate();
+    return 0;
+}
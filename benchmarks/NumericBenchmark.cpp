@@ -0,0 +1,99 @@
+/**
+ * @file    NumericBenchmark.cpp
+ * @brief   Microbenchmark of the fast paths of Log::operator<< against a std::ostringstream
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <LoggerCpp/LoggerCpp.h>
+
+#include <chrono>
+#include <cstdio>
+#include <ios>
+#include <sstream>
+#include <string>
+
+
+/// Number of iterations of each measure
+static const long NB_ITERATIONS = 1000000;
+
+/// Number of values inserted by each iteration
+static const long NB_INSERTIONS = 8;
+
+/// Written by each iteration of the std::ostringstream, so that it is not optimized out
+static volatile size_t sSink = 0;
+
+/// Run the lambda NB_ITERATIONS times, and return the time of one iteration in nanoseconds
+template <typename Lambda>
+static double measure(Lambda aLambda) {
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (long i = 0; i < NB_ITERATIONS; ++i) {
+        aLambda(i);
+    }
+    const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / NB_ITERATIONS;
+}
+
+/**
+ * @brief Compare the insertion of a value of some type into a Log, by its fast path and by the std::ostream fallback,
+ *        and into a std::ostringstream
+ *
+ * @param[in] apName        Name of the type
+ * @param[in] aLogger       Logger of the Log, without any Output
+ * @param[in] aEmptyLog     Time of an empty Log, subtracted from the time of the Log
+ * @param[in] aValueOf      Lambda returning the value inserted for an iteration
+ */
+template <typename ValueOf>
+static void compare(const char* apName, const Log::Logger& aLogger, double aEmptyLog, ValueOf aValueOf) {
+    const double fast = measure([&aLogger, &aValueOf](long i) {
+        const auto value = aValueOf(i);
+        aLogger.info() << value << value << value << value << value << value << value << value;
+    });
+    // std::uppercase leaves the decimal integers unchanged, but makes the numbers of the Log use the std::ostream
+    // (the strings only fall back to the std::ostream with a width)
+    const double fallback = measure([&aLogger, &aValueOf](long i) {
+        const auto value = aValueOf(i);
+        aLogger.info() << std::uppercase << value << value << value << value << value << value << value << value;
+    });
+    std::ostringstream stream;
+    const double ostream = measure([&stream, &aValueOf](long i) {
+        const auto value = aValueOf(i);
+        stream.str(std::string());
+        stream << value << value << value << value << value << value << value << value;
+        sSink = static_cast<size_t>(stream.tellp());
+    });
+
+    printf("%-12s Log::operator<< %6.1f ns, std::ostream fallback %6.1f ns, std::ostringstream %6.1f ns (x%.2f)\n",
+           apName, (fast - aEmptyLog) / NB_INSERTIONS, (fallback - aEmptyLog) / NB_INSERTIONS,
+           ostream / NB_INSERTIONS, ostream / (fast - aEmptyLog));
+}
+
+/**
+ * @brief Measure the time of the insertion of one value of each type (without the cost of the Log itself)
+ */
+int main() {
+    // No Output: measure only the formatting of the Log
+    Log::Config::Vector configList;
+    Log::Manager::configure(configList);
+
+    const Log::Logger   logger("Numeric.Benchmark");
+    const double        emptyLog = measure([&logger](long) { logger.info(); });
+    printf("empty Log %.1f ns, then time of one insertion:\n", emptyLog);
+
+    const std::string   str("a short string");
+    const int           values[16] = {0};
+
+    compare("int", logger, emptyLog, [](long i) { return static_cast<int>(i * 7919); });
+    compare("long long", logger, emptyLog, [](long i) { return static_cast<long long>(i) * 123456789; });
+    compare("double", logger, emptyLog, [](long i) { return static_cast<double>(i) * 0.37; });
+    compare("integral dbl", logger, emptyLog, [](long i) { return static_cast<double>(i); });
+    compare("pointer", logger, emptyLog, [&values](long i) { return &values[i % 16]; });
+    compare("const char*", logger, emptyLog, [](long) { return "a short string"; });
+    compare("std::string", logger, emptyLog, [&str](long) -> const std::string& { return str; });
+
+    Log::Manager::terminate();
+    return 0;
+}
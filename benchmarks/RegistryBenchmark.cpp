@@ -0,0 +1,73 @@
+/**
+ * @file    RegistryBenchmark.cpp
+ * @brief   Benchmark of the Channel registry of the Manager, creating short-lived Logger objects from many threads
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <LoggerCpp/LoggerCpp.h>
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/// Total number of Logger objects created by each measure
+static const long NB_LOGGERS = 1000000;
+
+/// Number of different Channel names looked up
+static const size_t NB_CHANNELS = 64;
+
+/// Create aNbLoggers short-lived Logger objects, cycling through the Channel names
+static void createLoggers(const std::vector<std::string>& aNames, size_t aFirst, long aNbLoggers) {
+    long nbEnabled = 0;
+    for (long i = 0; i < aNbLoggers; ++i) {
+        const Log::Logger logger(aNames[(aFirst + static_cast<size_t>(i)) % aNames.size()].c_str());
+        if (logger.isEnabled(Log::Log::eDebug)) {
+            ++nbEnabled;
+        }
+    }
+    if (nbEnabled != aNbLoggers) {
+        printf("unexpected Level of a Channel\n");
+    }
+}
+
+/// Create NB_LOGGERS Logger objects from aNbThreads threads, and print the time of one creation
+static void measure(const std::vector<std::string>& aNames, size_t aNbThreads) {
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t thread = 0; thread < aNbThreads; ++thread) {
+        threads.push_back(std::thread(createLoggers, std::cref(aNames), thread,
+                                      NB_LOGGERS / static_cast<long>(aNbThreads)));
+    }
+    for (size_t thread = 0; thread < aNbThreads; ++thread) {
+        threads[thread].join();
+    }
+    const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+    const double nano = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    printf("%2lu threads: %ld Logger in %8.3f ms, %7.1f ns/Logger, %6.2f million Logger/s\n",
+           static_cast<unsigned long>(aNbThreads), NB_LOGGERS, nano / 1000000, nano / NB_LOGGERS,
+           NB_LOGGERS * 1000 / nano);
+}
+
+/**
+ * @brief Create 10^6 Logger objects from 1 thread, then across 32 threads
+ */
+int main() {
+    std::vector<std::string> names;
+    for (size_t channel = 0; channel < NB_CHANNELS; ++channel) {
+        names.push_back("Registry.Benchmark.Channel" + std::to_string(channel));
+    }
+
+    measure(names, 1);
+    measure(names, 32);
+
+    Log::Manager::terminate();
+    return 0;
+}
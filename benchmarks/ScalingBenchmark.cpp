@@ -0,0 +1,89 @@
+/**
+ * @file    ScalingBenchmark.cpp
+ * @brief   Benchmark of the scaling of the asynchronous mode, from 1 to 64 logging threads
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <LoggerCpp/LoggerCpp.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+
+
+/// Total number of Log output by each measure, shared by the threads
+static const long NB_LOGS = 1 << 20;
+
+/// Output aNbLogs Log from the calling thread
+static void outputLogs(const Log::Logger& aLogger, long aNbLogs) {
+    for (long i = 0; i < aNbLogs; ++i) {
+        aLogger.info() << "scaling; index=" << i << " value=" << (i * 0.25);
+    }
+}
+
+/// Output NB_LOGS Log from aNbThreads threads, wait for all of them to be written, and print the throughput
+static void measure(const Log::Logger& aLogger, unsigned int aNbThreads, unsigned int aNbCores) {
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned int thread = 0; thread < aNbThreads; ++thread) {
+        threads.push_back(std::thread(outputLogs, std::cref(aLogger), NB_LOGS / aNbThreads));
+    }
+    for (unsigned int thread = 0; thread < aNbThreads; ++thread) {
+        threads[thread].join();
+    }
+    Log::Manager::flush();
+    const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+
+    // The producing threads only use as many cores as there are
+    const unsigned int  cores       = (aNbThreads < aNbCores) ? aNbThreads : aNbCores;
+    const double        seconds     = std::chrono::duration<double>(elapsed).count();
+    const double        throughput  = NB_LOGS / seconds;
+    printf("%2u threads: %7.3f s, %9.0f Log/s, %9.0f Log/s per core (%u cores)\n",
+           aNbThreads, seconds, throughput, throughput / cores, cores);
+}
+
+/**
+ * @brief Output 2^20 Log in asynchronous mode from 1, 2, 4 ... 64 threads
+ *
+ * @param[in] argc  2 to choose the mode
+ * @param[in] argv  The mode of the AsyncQueue: "per_thread" (default) or "shared"
+ */
+int main(int argc, char** argv) {
+    const char* pMode = (1 < argc) ? argv[1] : "per_thread";
+    if ((0 != strcmp(pMode, "per_thread")) && (0 != strcmp(pMode, "shared"))) {
+        fprintf(stderr, "usage: %s [per_thread|shared]\n", argv[0]);
+        return 1;
+    }
+
+    Log::Config::Ptr asyncConfigPtr(new Log::Config("AsyncQueue"));
+    asyncConfigPtr->setValue("queue_size",  "8192");
+    asyncConfigPtr->setValue("overflow",    "block");
+    asyncConfigPtr->setValue("mode",        pMode);
+    Log::Manager::configureAsync(asyncConfigPtr);
+
+    Log::Config::Vector configList;
+    Log::Config::addOutput(configList, "OutputFile");
+    Log::Config::setOption(configList, "filename",      "/dev/null");
+    Log::Config::setOption(configList, "filename_old",  "/dev/null");
+    Log::Config::setOption(configList, "max_size",      "2000000000");
+    Log::Config::setOption(configList, "flush_size",    "65536");
+    Log::Manager::configure(configList);
+
+    const unsigned int  hardware    = std::thread::hardware_concurrency();
+    const unsigned int  nbCores     = (0 < hardware) ? hardware : 1;
+    const Log::Logger   logger("Scaling.Benchmark");
+    printf("\"%s\" mode, %ld Log by measure:\n", pMode, NB_LOGS);
+    for (unsigned int nbThreads = 1; nbThreads <= 64; nbThreads *= 2) {
+        measure(logger, nbThreads, nbCores);
+    }
+
+    Log::Manager::terminate();
+    return 0;
+}
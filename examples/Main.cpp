@@ -13,13 +13,16 @@
 #include <iostream> // used for cerr messages
 
 
+/// The Logger of the Tester objects, built at compile time and looking its Channel up only once
+LOGGER_DECLARE(sTesterLogger, "main.Tester");
+
 /**
  * @brief Simple test class
  */
 class Tester {
 public:
     Tester() :
-        mLogger("main.Tester")
+        mLogger(sTesterLogger.get())
     {
     }
 
@@ -78,8 +81,17 @@ int main ()
     logger.debug() << "Variables ; '" << str << "', '" << ui << "', '" << dbl << "'";
     logger.debug() << "Hexa = " << std::hex << 0x75af0 << " test";
     logger.debug() << "Deci = " << std::right << std::setfill('0') << std::setw(8) << 76035 << " test";
+    // Same with format strings, bypassing the std::ostream
+    logger.debug("Variables ; '{}', '{}', '{}'", str, ui, dbl);
+    logger.debug("Hexa = {:x} test", 0x75af0);
+    LOGF_DEBUG(logger, "Deci = {:08} test", 76035);
     logger.debug() << "sizeof(logger)=" << sizeof(logger);
 
+    // The LOG_xxx() macros do not evaluate the operands of a disabled Log,
+    // and are compiled out below the LOGGERCPP_MIN_LEVEL defined at build time
+    LOG_DEBUG(logger) << "Macro debug = " << ui;
+    LOG_INFO(logger) << "Macro info = " << dbl;
+
     // Test outputs of various severity Level
     logger.debug()  << "Debug.";
     logger.info()   << "Info.";
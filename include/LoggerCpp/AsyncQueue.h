@@ -0,0 +1,216 @@
+/**
+ * @file    AsyncQueue.h
+ * @ingroup LoggerCpp
+ * @brief   Bounded lock-free multi-producer queue drained by a background writer thread
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <LoggerCpp/Log.h>
+#include <LoggerCpp/Channel.h>
+#include <LoggerCpp/Config.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace Log {
+
+
+/**
+ * @brief   Bounded lock-free multi-producer queue drained by a background writer thread
+ * @ingroup LoggerCpp
+ *
+ *  The AsyncQueue is used by the Manager in asynchronous mode: the Log destructor
+ * copies the finished record into a slot of a fixed-size ring buffer, and returns immediately.
+ * A background writer thread then drains the ring and outputs the records
+ * to the configured Output objects, so that logging threads never wait for disk or console I/O.
+ *
+ *  The ring is a bounded multi-producer/single-consumer queue where each slot carries
+ * a sequence number: producers reserve a slot with a compare-and-swap on the write position,
+ * and publish it by updating the slot sequence number. Slots are reused, so that the message string
+ * of each slot keeps its capacity: the steady state does not allocate memory.
+ *
+ *  In "per_thread" mode, the single shared ring is replaced by one wait-free single-producer ring per thread,
+ * registered on the first Log of the thread, and released when the thread exits:
+ * producers never write to a cache line shared with another producer.
+ * The writer thread merges the rings by timestamp (then by registration order of the rings),
+ * so that the Log are still output in global time order. Since a thread may be about to push a Log
+ * it has already timestamped, a Log is output only when every ring has a Log to compare it with,
+ * or when it is older than the "merge_window": the order is broken only by a thread descheduled
+ * for longer than the merge window between timestamping and pushing a Log, or by flush() not waiting for it.
+ */
+class AsyncQueue {
+public:
+    /**
+     * @brief Enumeration of the policies applied when the queue is full
+     */
+    enum Overflow {
+        eBlock = 0,         ///< "block" : wait for the writer thread to free a slot (no Log is ever lost)
+        eDropNewest,        ///< "drop_newest" : drop the Log that does not fit in the queue
+        eDropDebugFirst     ///< "drop_debug_first" : drop Debug Log when 3/4 full, wait when full for others
+    };
+
+public:
+    /**
+     * @brief Create the queue and start the writer thread
+     *
+     * @param[in] aConfigPtr    Config the queue with "queue_size", "overflow", "mode" and "merge_window"
+     */
+    explicit AsyncQueue(const Config::Ptr& aConfigPtr);
+
+    /// @brief Non virtual destructor : output all pending Log and stop the writer thread
+    ~AsyncQueue(void);
+
+    /**
+     * @brief Copy the Log into the queue, to be output by the writer thread
+     *
+     * @param[in] apChannelPtr  The underlying Channel of the Log, in the table of the Manager (never freed)
+     * @param[in] aLog          The Log to output
+     *
+     * @return false if the Log was dropped because of the overflow policy
+     */
+    bool push(const Channel::Ptr* apChannelPtr, const Log& aLog);
+
+    /**
+     * @brief Wait until all the Log pushed before this call have been output
+     */
+    void flush(void);
+
+    /// @brief Number of Log of the given Level dropped because of the overflow policy
+    inline unsigned long getDroppedCount(Log::Level aLevel) const {
+        return mDroppedCount[aLevel].load(std::memory_order_relaxed);
+    }
+
+    /// @brief Tell if the current thread is the writer thread
+    inline bool isWriterThread(void) const {
+        return (std::this_thread::get_id() == mThread.get_id());
+    }
+
+    /**
+     * @brief Convert an overflow policy string representation to its corresponding value
+     *
+     * @param[in] apOverflow Overflow policy string ("block", "drop_newest" or "drop_debug_first")
+     *
+     * @return Overflow policy value
+     */
+    static Overflow toOverflow(const char* apOverflow);
+
+private:
+    /// @brief A slot of the ring buffer, holding a copy of a Log
+    struct Slot {
+        std::atomic<size_t> mSequence;      ///< Sequence number used to publish the slot (shared ring only)
+        const Channel::Ptr* mpChannelPtr;   ///< The underlying Channel of the Log, in the table of the Manager
+        Log::Level          mSeverity;      ///< Severity Level of the Log
+        long long           mStamp;         ///< Raw stamp of the Log (see Clock), converted by the writer thread
+        const CallSite*     mpCallSite;     ///< Source location of the Log (or nullptr)
+        unsigned long       mThreadId;      ///< Id of the thread that produced the Log
+        const char*         mpThreadName;   ///< Padded name of the thread that produced the Log (or nullptr)
+        std::string         mMessage;       ///< Formatted message of the Log
+        size_t              mTextSize;      ///< Size of the text of the message, without the rendered fields
+        std::string         mFields;        ///< Encoded key/value fields of the Log
+        std::string         mArgs;          ///< Encoded arguments of the format string of the Log
+    };
+
+    /// @brief A single-producer ring of slots owned by a thread, in "per_thread" mode
+    struct Ring {
+        std::vector<Slot>   mSlots;         ///< Ring buffer of slots, its size is a power of two
+        char                mPadding1[64];  ///< Keep the positions of the producer and of the writer apart
+        std::atomic<size_t> mWritePos;      ///< Next position written by the producer thread
+        size_t              mReadCache;     ///< Read position last seen by the producer thread
+        char                mPadding2[64];  ///< Keep the positions of the producer and of the writer apart
+        std::atomic<size_t> mReadPos;       ///< Next position to be output by the writer thread
+        std::atomic<bool>   mbClosed;       ///< The producer thread has exited (no more Log will be written)
+    };
+
+    /// @brief Shared pointer to a Ring, owned by its producer thread and by the queue
+    typedef shared_ptr<Ring>    RingPtr;
+
+    /// @brief State of a Ring in the writer thread
+    struct Reader {
+        RingPtr             mRingPtr;       ///< The ring
+        size_t              mReadPos;       ///< Next position to output
+        size_t              mWriteCache;    ///< Write position last seen
+        long long           mHeadStamp;     ///< Timestamp of the Log at the read position (LLONG_MAX if empty)
+    };
+
+    /// @brief The Ring of the current thread, released at the exit of the thread (defined in AsyncQueue.cpp)
+    struct ThreadRing;
+    static thread_local ThreadRing mThreadRing;  ///< The Ring of the current thread
+
+    /// @brief Copy the Log into a slot
+    static void store(Slot& aSlot, const Channel::Ptr* apChannelPtr, const Log& aLog);
+
+    /// @brief Copy the Log into the Ring of the current thread ("per_thread" mode)
+    bool pushRing(const Channel::Ptr* apChannelPtr, const Log& aLog);
+
+    /// @brief Get the Ring of the current thread, registering a new one on its first Log
+    Ring& getRing(void);
+
+    /// @brief Main loop of the writer thread
+    void run(void);
+
+    /// @brief Main loop of the writer thread in "per_thread" mode : merge the rings by timestamp
+    void runMerge(void);
+
+    /**
+     * @brief Output the Log of the rings in timestamp order (writer thread only)
+     *
+     * @param[in,out] aReaders  State of all the rings
+     * @param[in]     aBound    Timestamp up to which a Log can be output while a ring is empty
+     *
+     * @return Number of Log output
+     */
+    size_t merge(std::vector<Reader>& aReaders, long long aBound);
+
+    /// @brief Wake up the writer thread if it is waiting for new Log
+    void wakeUp(void);
+
+    /// @brief Output a Log and release its slot (writer thread only)
+    void output(Slot& aSlot);
+
+    /// @brief Approximate number of Log currently in the queue
+    inline size_t size(void) const {
+        return mWritePos.load(std::memory_order_relaxed) - mReadPos.load(std::memory_order_relaxed);
+    }
+
+    /// @{ Non-copyable object
+    AsyncQueue(const AsyncQueue&);
+    void operator=(const AsyncQueue&);
+    /// @}
+
+private:
+    std::vector<Slot>           mSlots;         ///< Ring buffer of slots, its size is a power of two
+    size_t                      mMask;          ///< Mask to convert a position to an index in the ring
+    Overflow                    mOverflow;      ///< Policy applied when the queue is full
+    bool                        mbPerThread;    ///< "mode" : one ring per thread ("per_thread") or a "shared" one
+    long long                   mMergeWindow;   ///< "merge_window" : nanoseconds waited for the empty rings
+    unsigned long               mId;            ///< Unique id of the queue, to find the Ring of a thread
+    std::atomic<size_t>         mWritePos;      ///< Next position to be reserved by a producer
+    std::atomic<size_t>         mReadPos;       ///< Next position to be output by the writer thread
+    std::atomic<unsigned long>  mDroppedCount[Log::eCritic + 1];   ///< Number of dropped Log by Level
+
+    std::atomic<bool>           mbSleeping;     ///< The writer thread is (about to be) waiting for new Log
+    std::atomic<bool>           mbStopping;     ///< The writer thread shall stop when the queue is empty
+    std::mutex                  mMutex;         ///< Mutex protecting the wait of the writer and of flush()
+    std::condition_variable     mWakeUp;        ///< Condition to wake up the writer thread
+    std::condition_variable     mFlushed;       ///< Condition signaled each time the queue is empty
+    std::thread                 mThread;        ///< The writer thread
+
+    std::mutex                  mRingsMutex;    ///< Mutex protecting the lists of rings
+    std::vector<RingPtr>        mRings;         ///< All the rings not yet released
+    std::vector<RingPtr>        mNewRings;      ///< The rings registered since the writer thread last looked
+    std::atomic<bool>           mbNewRings;     ///< New rings have been registered
+    std::atomic<int>            mFlushing;      ///< Number of threads waiting in flush() (output without waiting)
+};
+
+
+} // namespace Log
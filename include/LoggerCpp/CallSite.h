@@ -0,0 +1,133 @@
+/**
+ * @file    CallSite.h
+ * @ingroup LoggerCpp
+ * @brief   Compile-time description of the source location of a Log statement
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <LoggerCpp/Log.h>
+
+#include <atomic>
+
+
+namespace Log {
+
+
+/**
+ * @brief   Compile-time description of the source location of a Log statement
+ * @ingroup LoggerCpp
+ *
+ *  Each LOG_DEBUG() ... LOGF_CRITIC() macro declares a static constexpr CallSite with its file, line, function,
+ * Level and format string (for the LOGF_xxx() ones): it is built by the compiler, without any code run at startup,
+ * and the Log produced there only carries a pointer to it (see Log::getCallSite()).
+ * The text outputs print it with the "%s", "%g", "%#" and "%!" directives of their "pattern",
+ * and the OutputBinary stores each CallSite once per file, the Log only referring to it by its id.
+ *
+ *  A CallSite is registered by the Manager on its first execution, enabled or not, getting a unique id,
+ * and the Manager::getCallSites() list then gives all the call sites executed since startup.
+ *
+ *  Each CallSite also has a State byte, checked inline by the macro before the Level of its Logger:
+ * Manager::setCallSites() enables or disables call sites by file, function, line range or Channel,
+ * like the "dynamic debug" of the Linux kernel, for instance to enable a single LOG_DEBUG() of a Channel at "INFO".
+ * A call site in its eDefault state costs one more predictable branch than before, on a byte read at each execution,
+ * and a disabled one does not even read the Level of its Logger.
+ */
+class CallSite {
+    friend struct Manager;
+
+public:
+    /**
+     * @brief Enumeration of the states of a CallSite
+     */
+    enum State {
+        eUnregistered = 0,  ///< Not executed yet, to be registered by the Manager
+        eDefault,           ///< Enabled by the Level of its Logger
+        eEnabled,           ///< Always enabled, whatever the Level of its Logger
+        eDisabled           ///< Always disabled, whatever the Level of its Logger
+    };
+
+    /**
+     * @brief Constructor (constexpr, so that a static CallSite is initialized at compile time)
+     *
+     * @param[in] apFile        Source file (__FILE__)
+     * @param[in] aLine         Line in the source file (__LINE__)
+     * @param[in] apFunction    Function (__func__)
+     * @param[in] aLevel        Severity Level of the Log statement
+     * @param[in] apFormat      Format string of the Log statement, or nullptr for a stream
+     */
+    constexpr CallSite(const char* apFile, int aLine, const char* apFunction, Log::Level aLevel,
+                       const char* apFormat = nullptr) :
+        mpFile(apFile),
+        mLine(aLine),
+        mpFunction(apFunction),
+        mLevel(aLevel),
+        mpFormat(apFormat),
+        mpBaseName(apFile),
+        mId(0),
+        mState(eUnregistered)
+    {}
+
+    /// @brief Source file, as given by the compiler (__FILE__)
+    inline const char* getFile(void) const {
+        return mpFile;
+    }
+
+    /// @brief Name of the source file without its directories (valid once registered)
+    inline const char* getBaseName(void) const {
+        return mpBaseName;
+    }
+
+    /// @brief Line in the source file
+    inline int getLine(void) const {
+        return mLine;
+    }
+
+    /// @brief Function
+    inline const char* getFunction(void) const {
+        return mpFunction;
+    }
+
+    /// @brief Severity Level of the Log statement
+    inline Log::Level getLevel(void) const {
+        return mLevel;
+    }
+
+    /// @brief Format string of the Log statement, or nullptr for a stream
+    inline const char* getFormat(void) const {
+        return mpFormat;
+    }
+
+    /// @brief Unique id of the CallSite, from 1 in order of registration (0 until its first execution)
+    inline unsigned int getId(void) const {
+        return mId.load(std::memory_order_acquire);
+    }
+
+    /// @brief State of the CallSite, see Manager::setCallSites()
+    inline State getState(void) const {
+        return static_cast<State>(mState.load(std::memory_order_acquire));
+    }
+
+private:
+    /// @{ Non-copyable object
+    CallSite(const CallSite&);
+    void operator=(const CallSite&);
+    /// @}
+
+private:
+    const char* const                   mpFile;     ///< Source file
+    const int                           mLine;      ///< Line in the source file
+    const char* const                   mpFunction; ///< Function
+    const Log::Level                    mLevel;     ///< Severity Level
+    const char* const                   mpFormat;   ///< Format string, or nullptr
+    mutable const char*                 mpBaseName; ///< Source file without its directories, set on registration
+    mutable std::atomic<unsigned int>   mId;        ///< Unique id, set on registration (0 before)
+    mutable std::atomic<unsigned char>  mState;     ///< State, set on registration and by Manager::setCallSites()
+};
+
+
+} // namespace Log
@@ -12,8 +12,11 @@
 
 #include <LoggerCpp/Log.h>
 
-#include <map>
+#include <atomic>
+#include <chrono>
+#include <cstring>
 #include <string>
+#include <unordered_map>
 
 // The following includes "boost/shared_ptr.hpp" if LOGGER_USE_BOOST_SHARED_PTR is defined,
 // or <memory> (or <tr1/memory>) when C++11 (or experimental C++0x) is available,
@@ -33,13 +36,46 @@ namespace Log {
  * associate a named prefix and an output Log::Level.
  * Sharing a same Channel between multiple Logger enable changing the
  * Level of many Logger objects at once.
+ *
+ * The Level is atomic, so that it can be changed at any time while other threads are logging;
+ * reading it is a relaxed atomic load, as cheap as a plain one.
+ *
+ *  A Channel can also collapse identical consecutive Log into a single "last message repeated N times" Log,
+ * see setCollapse(). This is opt-in, as it has to hash each message output by the Channel.
+ *
+ *  A Channel can sample its Log below a given Level, keeping only 1 in N of them, or each with a probability p,
+ * see setSampling(). The decision is made by the constructor of the Log, before any formatting.
  */
 class Channel {
 public:
+    /// @brief Hash of a null-terminated Channel name (FNV-1a)
+    struct Hash {
+        /// @brief Hash the provided name
+        inline size_t operator()(const char* apName) const {
+            size_t hash = static_cast<size_t>(2166136261U);
+            for (; '\0' != *apName; ++apName) {
+                hash = (hash ^ static_cast<unsigned char>(*apName)) * static_cast<size_t>(16777619U);
+            }
+            return hash;
+        }
+    };
+    /// @brief Equality of null-terminated Channel names
+    struct Equal {
+        /// @brief Compare the provided names
+        inline bool operator()(const char* apLeft, const char* apRight) const {
+            return (0 == strcmp(apLeft, apRight));
+        }
+    };
+
     /// @brief Shared Pointer to a Channel object
     typedef shared_ptr<Channel>         Ptr;
-    /// @brief Map of shared pointer of Channel objects
-    typedef std::map<std::string, Ptr>  Map;
+    /**
+     * @brief Map of shared pointer of Channel objects, by name
+     *
+     * The key is the name interned by the Channel itself, so that a lookup by a C string
+     * does not need to build a temporary std::string.
+     */
+    typedef std::unordered_map<const char*, Ptr, Hash, Equal>  Map;
 
 public:
     /**
@@ -50,7 +86,17 @@ public:
      */
     Channel(const char* apChannelName, Log::Level aChannelLevel) :
         mName(apChannelName),
-        mLevel(aChannelLevel)
+        mLevel(aChannelLevel),
+        mbCollapse(false),
+        mCollapsed(COLLAPSE_NONE),
+        mSampleBelow(Log::eDebug),
+        mSampleEvery(0),
+        mSampleThreshold(SAMPLE_ALL),
+        mSamplePeriod(0),
+        mSampleCount(0),
+        mSampledOut(0),
+        mNextReport(0),
+        mRoutes(0)
     {}
 
     /// @brief Non virtual destructor
@@ -64,23 +110,210 @@ public:
 
     /// @brief Set the current output Log::Level of the Channel
     inline void setLevel(Log::Level aLevel) {
-        mLevel = aLevel;
+        mLevel.store(aLevel, std::memory_order_relaxed);
     }
 
     /// @brief Current Log::Level of the Channel
     inline Log::Level getLevel(void) const {
-        return mLevel;
+        return mLevel.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Enable the collapsing of identical consecutive Log into a "last message repeated N times" Log
+    inline void setCollapse(bool abCollapse) {
+        mbCollapse.store(abCollapse, std::memory_order_relaxed);
+    }
+
+    /// @brief Tell if identical consecutive Log are collapsed
+    inline bool getCollapse(void) const {
+        return mbCollapse.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Record a Log for the collapsing of identical consecutive Log (lock-free)
+     *
+     *  The hash and Level of the last Log, and its number of repetitions, are packed into a single word
+     * updated by a compare-and-swap, so that concurrent threads never attribute a repetition to another Log:
+     * the counts are exact, only the order of a "repeated" report relative to the Log of other threads may vary.
+     * After COLLAPSE_MAX repetitions, the count is reported and the Log output again.
+     *
+     * @param[in]  aHash            Hash of the message of the Log
+     * @param[in]  aLevel           Level of the Log
+     * @param[out] aRepeatedLevel   Level of the previous Log, when it has been repeated
+     *
+     * @return -1 if the Log repeats the previous one and is not to be output,
+     *         or else the number of repetitions of the previous Log to report before this one (usually 0)
+     */
+    inline long collapse(unsigned long long aHash, Log::Level aLevel, Log::Level& aRepeatedLevel) {
+        const unsigned long long last   = (aHash & COLLAPSE_HASH) | static_cast<unsigned long long>(aLevel);
+        unsigned long long       state  = mCollapsed.load(std::memory_order_relaxed);
+        for (;;) {
+            const long repeated = static_cast<long>((state & COLLAPSE_COUNT) >> 3);
+            if (((state & ~COLLAPSE_COUNT) == last) && (repeated < COLLAPSE_MAX)) {
+                if (mCollapsed.compare_exchange_weak(state, state + (1ULL << 3), std::memory_order_relaxed)) {
+                    return -1;
+                }
+            } else if (mCollapsed.compare_exchange_weak(state, last, std::memory_order_relaxed)) {
+                aRepeatedLevel = static_cast<Log::Level>(state & 7);
+                return repeated;
+            }
+        }
+    }
+
+    /**
+     * @brief Take the number of repetitions of the last Log not reported yet
+     *
+     * @param[out] aRepeatedLevel   Level of the last Log
+     *
+     * @return Number of repetitions of the last Log not reported yet
+     */
+    inline long takeRepeated(Log::Level& aRepeatedLevel) {
+        unsigned long long state = mCollapsed.load(std::memory_order_relaxed);
+        while ((0 != (state & COLLAPSE_COUNT))
+            && !mCollapsed.compare_exchange_weak(state, state & ~COLLAPSE_COUNT, std::memory_order_relaxed)) {
+        }
+        aRepeatedLevel = static_cast<Log::Level>(state & 7);
+        return static_cast<long>((state & COLLAPSE_COUNT) >> 3);
+    }
+
+    /**
+     * @brief Sample the Log below the given Level, keeping only 1 in N of them, or each with a probability p
+     *
+     * @param[in] aBelow    Log::Level below which Log are sampled (eDebug disables the sampling)
+     * @param[in] aRate     Keep 1 in N Log if >= 1, or else keep each Log with this probability
+     * @param[in] aPeriod   Seconds between the reports of the number of Log sampled out (0 only on flush)
+     */
+    inline void setSampling(Log::Level aBelow, double aRate, long aPeriod) {
+        mSampleEvery.store((aRate >= 1.0) ? static_cast<unsigned long>(aRate) : 0, std::memory_order_relaxed);
+        mSampleThreshold.store((aRate >= 1.0) ? SAMPLE_ALL :
+                               (aRate <= 0.0) ? 0 : static_cast<unsigned long long>(aRate * SAMPLE_ALL),
+                               std::memory_order_relaxed);
+        mSamplePeriod.store(aPeriod * 1000000000LL, std::memory_order_relaxed);
+        mSampleBelow.store(aBelow, std::memory_order_relaxed);
+    }
+
+    /// @brief Log::Level below which Log are sampled (eDebug if the sampling is disabled)
+    inline Log::Level getSampleBelow(void) const {
+        return mSampleBelow.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Sampling rate : N when keeping 1 in N Log, or else the probability to keep a Log
+    inline double getSampleRate(void) const {
+        const unsigned long every = mSampleEvery.load(std::memory_order_relaxed);
+        return (0 != every) ? every : static_cast<double>(mSampleThreshold.load(std::memory_order_relaxed)) / SAMPLE_ALL;
+    }
+
+    /// @brief Seconds between the reports of the number of Log sampled out
+    inline long getSamplePeriod(void) const {
+        return static_cast<long>(mSamplePeriod.load(std::memory_order_relaxed) / 1000000000LL);
+    }
+
+    /**
+     * @brief Decide if an enabled Log is kept by the sampling (lock-free)
+     *
+     * @param[in] aLevel    Level of the Log
+     *
+     * @return true if the Log is to be output, false if it is sampled out
+     */
+    inline bool sample(Log::Level aLevel) {
+        if (aLevel >= mSampleBelow.load(std::memory_order_relaxed)) {
+            return true;
+        }
+        bool bKeep;
+        const unsigned long every = mSampleEvery.load(std::memory_order_relaxed);
+        if (0 != every) {
+            bKeep = (0 == mSampleCount.fetch_add(1, std::memory_order_relaxed) % every);
+        } else {
+            bKeep = (nextRandom() < mSampleThreshold.load(std::memory_order_relaxed));
+        }
+        if (!bKeep) {
+            mSampledOut.fetch_add(1, std::memory_order_relaxed);
+        }
+        return bKeep;
+    }
+
+    /**
+     * @brief Take the number of Log sampled out, when it is time to report it
+     *
+     * @param[in] abNow     Take it now, whatever the time of the last report
+     *
+     * @return Number of Log sampled out since the last report (0 if not yet time to report)
+     */
+    inline long takeSampledOut(bool abNow) {
+        if (!abNow) {
+            const long long now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    std::chrono::steady_clock::now().time_since_epoch()).count();
+            const long long period  = mSamplePeriod.load(std::memory_order_relaxed);
+            long long       next    = mNextReport.load(std::memory_order_relaxed);
+            if ((0 == period) || (now < next)
+             || !mNextReport.compare_exchange_strong(next, now + period, std::memory_order_relaxed)) {
+                return 0;
+            }
+        }
+        return (0 != mSampledOut.load(std::memory_order_relaxed)) ?
+                mSampledOut.exchange(0, std::memory_order_relaxed) : 0;
+    }
+
+    /**
+     * @brief Route of the Log of the Channel, computed by the Manager from the Config of the Output objects
+     *
+     * @return Generation tag of the list of Output objects in the 16 high bits,
+     *         and the bits of the Output objects wanting the Log of the Channel below
+     */
+    inline unsigned long long getRoutes(void) const {
+        return mRoutes.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Set the route of the Log of the Channel, see getRoutes()
+    inline void setRoutes(unsigned long long aRoutes) {
+        mRoutes.store(aRoutes, std::memory_order_relaxed);
     }
 
 private:
+    /// @brief 32 bits random number from a per-thread xorshift64* generator
+    static inline unsigned long long nextRandom(void) {
+        static thread_local unsigned long long sState = 0;
+        if (0 == sState) {
+            // Seed each thread differently, from the address of its state and the clock
+            sState = (reinterpret_cast<unsigned long long>(&sState) * 0x9E3779B97F4A7C15ULL)
+                   ^ static_cast<unsigned long long>(std::chrono::steady_clock::now().time_since_epoch().count())
+                   ^ 1;
+        }
+        sState ^= sState >> 12;
+        sState ^= sState << 25;
+        sState ^= sState >> 27;
+        return (sState * 0x2545F4914F6CDD1DULL) >> 32;
+    }
+
+    /// @brief Bits of the collapsing state holding the number of repetitions, between the Level and the hash
+    static const unsigned long long COLLAPSE_COUNT = 0xFFFFF8ULL;
+    /// @brief Bits of the collapsing state holding the high 40 bits of the hash of the last Log
+    static const unsigned long long COLLAPSE_HASH = ~0xFFFFFFULL;
+    /// @brief Collapsing state before the first Log (an invalid Level matching no Log)
+    static const unsigned long long COLLAPSE_NONE = COLLAPSE_HASH | 7;
+    /// @brief Maximum number of repetitions counted before reporting them
+    static const long COLLAPSE_MAX = 0x1FFFFF;
+
+    /// @brief Sampling threshold keeping all the Log (2^32, above any 32 bits random number)
+    static const unsigned long long SAMPLE_ALL = 0x100000000ULL;
+
     /// @{ Non-copyable object
     Channel(Channel&);
     void operator=(Channel&);
     /// @}
 
 private:
-    std::string mName;  ///< Name of the Channel
-    Log::Level  mLevel; ///< Current Log::Level of the Channel
+    std::string             mName;      ///< Name of the Channel
+    std::atomic<Log::Level> mLevel;     ///< Current Log::Level of the Channel
+    std::atomic<bool>       mbCollapse; ///< Collapse identical consecutive Log
+    std::atomic<unsigned long long> mCollapsed; ///< Hash and Level of the last Log, and its repetitions not reported
+    std::atomic<Log::Level> mSampleBelow;       ///< Log::Level below which Log are sampled
+    std::atomic<unsigned long>      mSampleEvery;       ///< Keep 1 in N Log (0 to use the probability)
+    std::atomic<unsigned long long> mSampleThreshold;   ///< Probability to keep a Log, as a 32 bits threshold
+    std::atomic<long long>  mSamplePeriod;      ///< Nanoseconds between the reports of the Log sampled out
+    std::atomic<unsigned long>      mSampleCount;       ///< Number of Log considered for the 1 in N sampling
+    std::atomic<long>       mSampledOut;        ///< Number of Log sampled out since the last report
+    std::atomic<long long>  mNextReport;        ///< Steady clock time of the next report
+    std::atomic<unsigned long long> mRoutes;    ///< Generation tag and bits of the Output objects of the Channel
 };
 
 
@@ -0,0 +1,126 @@
+/**
+ * @file    Clock.h
+ * @ingroup LoggerCpp
+ * @brief   Raw timestamp capture, calibrated against the wall clock to be converted later to a DateTime
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <atomic>
+
+
+namespace Log {
+
+
+/**
+ * @brief   Raw timestamp capture, calibrated against the wall clock to be converted later to a DateTime
+ * @ingroup LoggerCpp
+ *
+ *  A Log only captures a raw "stamp" with now() when it is output, and converts it to the wall clock,
+ * then to the calendar fields of a DateTime, only when an Output asks for them (see Log::getTime()).
+ * In asynchronous mode, this conversion is thus done by the writer thread instead of the logging threads.
+ *
+ * The source of the stamps is chosen by setSource():
+ * - eRealtime (default): the wall clock itself, in nanoseconds since the Epoch (clock_gettime(CLOCK_REALTIME))
+ * - eMonotonicRaw: CLOCK_MONOTONIC_RAW under Linux, not slewed by NTP (std::chrono::steady_clock elsewhere)
+ * - eTsc: the time-stamp counter of x86 processors read by "rdtsc", only if it is invariant
+ *   (constant rate, synchronized between the cores), else falls back to eMonotonicRaw
+ *
+ *  The raw sources are calibrated by setSource(), and then synchronized again with the wall clock
+ * once per second of stamps by the thread converting them: the rate of the counter is measured again
+ * on each synchronization, so that the drift between the counter and the wall clock does not accumulate.
+ */
+class Clock {
+public:
+    /**
+     * @brief Enumeration of the sources of the stamps
+     */
+    enum Source {
+        eRealtime = 0,  ///< Wall clock, nanoseconds since the Epoch
+        eMonotonicRaw,  ///< Monotonic clock, not slewed by NTP
+        eTsc            ///< Invariant time-stamp counter of x86 processors
+    };
+
+    /**
+     * @brief Select the source of the stamps, and calibrate it against the wall clock
+     *
+     *  To be called before logging, or at least while no Log is being output,
+     * since stamps captured from the previous source can not be converted anymore.
+     * Calibrating eTsc takes about 10 milliseconds.
+     *
+     * @param[in] aSource   Source of the stamps
+     */
+    static void setSource(Source aSource);
+
+    /// @brief The source of the stamps (eMonotonicRaw if eTsc was asked for without an invariant time-stamp counter)
+    static Source getSource(void);
+
+    /**
+     * @brief Convert a string representation of a Source to its corresponding value
+     *
+     * @param[in] apSource  "realtime", "monotonic_raw" or "tsc"
+     *
+     * @return Source value
+     *
+     * @throw Exception on an unknown source
+     */
+    static Source toSource(const char* apSource);
+
+    /// @brief Capture a raw stamp from the current source
+    static long long now(void);
+
+    /// @brief Current wall clock time, in nanoseconds since the Epoch (UTC)
+    static long long getRealtime(void);
+
+    /**
+     * @brief Convert a stamp to the wall clock, in nanoseconds since the Epoch (UTC)
+     *
+     * Synchronize again the calibration with the wall clock if the stamp is one second past it.
+     *
+     * @param[in] aStamp    Stamp captured by now()
+     *
+     * @return Nanoseconds since the Epoch
+     */
+    static long long toEpochNano(long long aStamp);
+
+    /**
+     * @brief Convert a duration in nanoseconds to a difference of stamps
+     *
+     * @param[in] aNanoseconds  Duration in nanoseconds
+     *
+     * @return Number of ticks of the source
+     */
+    static long long toTicks(long long aNanoseconds);
+
+private:
+    /**
+     * @brief Capture a raw stamp from the given source
+     *
+     * @param[in] aSource   Source of the stamp
+     *
+     * @return Stamp
+     */
+    static long long read(Source aSource);
+
+    /**
+     * @brief Read the source and the wall clock together, keeping the closest of a few pairs
+     *
+     * @param[in]  aSource  Source of the stamp
+     * @param[out] aStamp   Stamp of the source
+     * @param[out] aNano    Wall clock at the same time, in nanoseconds since the Epoch
+     */
+    static void sample(Source aSource, long long& aStamp, long long& aNano);
+
+    /// @brief Synchronize again the calibration with the wall clock
+    static void synchronize(void);
+
+private:
+    static std::atomic<Source>  mSource;    ///< Source of the stamps
+};
+
+
+} // namespace Log
@@ -1,7 +1,7 @@
 /**
  * @file    DateTime.h
  * @ingroup LoggerCpp
- * @brief   Current time precise to the millisecond.
+ * @brief   Current time precise to the nanosecond.
  *
  * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
  *
@@ -15,13 +15,16 @@ namespace Log {
 
 
 /**
- * @brief   Current time precise to the millisecond.
+ * @brief   Current time precise to the nanosecond.
  * @ingroup LoggerCpp
  *
  * Using a struct to enable easy direct access to public members.
  *
- * Under Windows, the time is given to the millisecond.
- * Under Linux, the time is given to the microsecond.
+ * Under Windows, the time is given to the 100 nanoseconds.
+ * Under Linux, the time is given to the nanosecond, using clock_gettime() (through the vDSO).
+ *
+ * Each thread caches the calendar fields of the current second, and their "YYYY-MM-DD HH:MM:SS" text,
+ * so that the conversion to local time is only done once per second.
  */
 struct DateTime {
     /**
@@ -34,14 +37,34 @@ struct DateTime {
      */
     void make(void);
 
-    int year;    ///< year    [0,30827]
-    int month;   ///< month   [1,12]
-    int day;     ///< day     [1,31]
-    int hour;    ///< hour    [0,23]
-    int minute;  ///< minute  [0,59]
-    int second;  ///< second  [0,59]
-    int ms;      ///< millisecond
-    int us;      ///< microsecond (not under Windows)
+    /**
+     * @brief Set to the given time
+     *
+     * @param[in] aEpochNano    Nanoseconds since the Epoch (UTC), see Clock::toEpochNano()
+     */
+    void set(long long aEpochNano);
+
+    /**
+     * @brief Use UTC instead of the local time zone for the calendar fields of all new DateTime
+     *
+     * UTC skips the time zone conversion completely. Default is local time.
+     *
+     * @param[in] abUtc true to use UTC, false to use the local time zone
+     */
+    static void setUtc(bool abUtc);
+
+    /// @brief true if the calendar fields of new DateTime are in UTC, false if they are in the local time zone
+    static bool isUtc(void);
+
+    int         year;       ///< year    [0,30827]
+    int         month;      ///< month   [1,12]
+    int         day;        ///< day     [1,31]
+    int         hour;       ///< hour    [0,23]
+    int         minute;     ///< minute  [0,59]
+    int         second;     ///< second  [0,59]
+    int         ns;         ///< nanosecond [0,999999999]
+    long long   epoch;      ///< seconds since the Epoch (1970-01-01 00:00:00 UTC)
+    char        text[20];   ///< date and time pre-rendered as "YYYY-MM-DD HH:MM:SS" (null-terminated)
 };
 
 
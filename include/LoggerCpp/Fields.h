@@ -0,0 +1,240 @@
+/**
+ * @file    Fields.h
+ * @ingroup LoggerCpp
+ * @brief   Typed key/value fields of a structured Log, encoded in a compact binary buffer
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <LoggerCpp/Stream.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+
+namespace Log {
+
+
+/**
+ * @brief   A key/value field to insert into a Log, see kv()
+ * @ingroup LoggerCpp
+ *
+ * Only references the key and the value, which shall live until the end of the Log statement.
+ */
+template <typename T>
+struct KeyValue {
+    const char* mpKey;      ///< Name of the field
+    const T&    mValue;     ///< Value of the field
+};
+
+/**
+ * @brief Make a key/value field to insert into a Log : logger.info() << "login" << Log::kv("user", id);
+ *
+ * @param[in] apKey     Name of the field (up to 255 characters)
+ * @param[in] aValue    Value of the field: boolean, integer, floating point, string, or any type with an operator<<
+ *
+ * @return A KeyValue referencing the key and the value
+ */
+template <typename T>
+inline KeyValue<T> kv(const char* apKey, const T& aValue) {
+    KeyValue<T> keyValue = { apKey, aValue };
+    return keyValue;
+}
+
+
+/**
+ * @brief   Typed key/value fields of a structured Log, encoded in a compact binary buffer
+ * @ingroup LoggerCpp
+ *
+ *  The fields of a Log are encoded one after the other in a buffer recycled with its Stream:
+ * a type byte, a key size byte, the key, and the value (a byte for a boolean, 8 bytes for a number,
+ * or a 4 bytes size followed by the characters of a string).
+ *
+ *  Structured outputs like the OutputJson decode them with next(),
+ * while the text outputs get them rendered as " key=value" at the end of the message.
+ */
+class Fields {
+public:
+    /// @brief Type of a field
+    enum Type {
+        eBool = 0,  ///< bool
+        eInt,       ///< Signed integer
+        eUint,      ///< Unsigned integer
+        eDouble,    ///< Floating point
+        eString     ///< String (also used for any type with an operator<<)
+    };
+
+    /// @brief A field decoded by next()
+    struct Field {
+        Type                type;       ///< Type of the value
+        const char*         pKey;       ///< Name of the field (not null-terminated)
+        size_t              keySize;    ///< Size of the name
+        bool                b;          ///< Value of an eBool field
+        long long           i;          ///< Value of an eInt field
+        unsigned long long  u;          ///< Value of an eUint field
+        double              d;          ///< Value of an eDouble field
+        const char*         pString;    ///< Value of an eString field (not null-terminated)
+        size_t              stringSize; ///< Size of an eString value
+    };
+
+    /**
+     * @brief Encode a field at the end of the buffer of the fields of a Stream
+     *
+     * @param[in,out] aStream   Stream of the Log, holding the buffer of its fields (see Stream::fields())
+     * @param[in]     apKey     Name of the field
+     * @param[in]     aValue    Value of the field
+     */
+    template <typename T>
+    static void append(Stream& aStream, const char* apKey, const T& aValue) {
+        appendValue(aStream, aStream.fields(), apKey, aValue, Category<T>());
+    }
+
+    /**
+     * @brief Encode the arguments of a format string as fields without key, into the buffer of the arguments
+     *        of a Stream (see Stream::args()), for the Output objects formatting the message themselves
+     *
+     * @param[in,out] aStream   Stream of the Log, holding the buffer of its arguments
+     * @param[in]     aArgs     Arguments of the format string
+     */
+    template <typename... Args>
+    static void appendArgs(Stream& aStream, const Args&... aArgs) {
+        const int expand[] = { 0, (appendValue(aStream, aStream.args(), "", aArgs, Category<Args>()), 0)... };
+        (void)expand;
+    }
+
+    /**
+     * @brief Tell if the arguments of the format strings of the LOGF_xxx() macros are to be encoded,
+     *        that is if an Output is formatting the messages itself (see addArgsOutput())
+     */
+    static inline bool isArgsEncoded(void) {
+        return (0 != mArgsOutputs.load(std::memory_order_relaxed));
+    }
+
+    /// @{ Count the Output objects formatting the messages from their arguments (in their constructor and destructor)
+    static void addArgsOutput(void);
+    static void removeArgsOutput(void);
+    /// @}
+
+    /**
+     * @brief Decode the next field of a buffer
+     *
+     * @param[in,out] apData    Current position in the buffer, moved to the next field
+     * @param[in]     apEnd     End of the buffer
+     * @param[out]    aField    Decoded field
+     *
+     * @return false at the end of the buffer, or if the field is truncated
+     */
+    static bool next(const char*& apData, const char* apEnd, Field& aField);
+
+    /// @brief Size of a buffer big enough for any number converted by toChars()
+    static const size_t MAX_CHARS = 32;
+
+    /// @{ Convert a number to its decimal representation, in a buffer of MAX_CHARS (not null-terminated)
+    static size_t toChars(char* apBuffer, long long aValue);
+    static size_t toChars(char* apBuffer, unsigned long long aValue);
+    /// @}
+
+    /**
+     * @brief Convert a finite double to the shortest decimal representation that reads back exactly
+     *
+     *  A value with up to 9 decimals is converted with the fewest decimals, as an integer,
+     * any other one with the fewest significant digits (15, 16 or 17) of snprintf() reading back to the same value.
+     *
+     * @param[out] apBuffer Buffer of MAX_CHARS
+     * @param[in]  aValue   Finite value
+     *
+     * @return Number of characters written (not null-terminated)
+     */
+    static size_t toChars(char* apBuffer, double aValue);
+
+    /**
+     * @brief Render the fields at the end of a text message, as " key=value"
+     *
+     * @param[in,out] aStream   Stream of the message
+     * @param[in]     apFields  Buffer of the fields
+     * @param[in]     aSize     Size of the buffer of the fields
+     */
+    static void render(Stream& aStream, const char* apFields, size_t aSize);
+
+private:
+    /// @brief Category of the type of a value: 0 string, 1 signed, 2 unsigned, 3 floating point, 4 bool
+    template <typename T>
+    using Category = std::integral_constant<int, std::is_floating_point<T>::value ? 3 :
+                                                 !std::is_integral<T>::value ? 0 :
+                                                 std::is_same<T, bool>::value ? 4 :
+                                                 std::is_same<T, char>::value ? 0 :
+                                                 std::is_signed<T>::value ? 1 : 2>;
+
+    /// @{ Encode a field into a buffer of the Stream according to the category of its value
+    template <typename T>
+    static void appendValue(Stream& aStream, std::string& aFields, const char* apKey, const T& aValue,
+                            std::integral_constant<int, 0>) {
+        appendString(aStream, aFields, apKey, aValue);
+    }
+    template <typename T>
+    static void appendValue(Stream&, std::string& aFields, const char* apKey, const T& aValue,
+                            std::integral_constant<int, 1>) {
+        const long long value = aValue;
+        appendNumber(aFields, eInt, apKey, &value);
+    }
+    template <typename T>
+    static void appendValue(Stream&, std::string& aFields, const char* apKey, const T& aValue,
+                            std::integral_constant<int, 2>) {
+        const unsigned long long value = aValue;
+        appendNumber(aFields, eUint, apKey, &value);
+    }
+    template <typename T>
+    static void appendValue(Stream&, std::string& aFields, const char* apKey, const T& aValue,
+                            std::integral_constant<int, 3>) {
+        const double value = static_cast<double>(aValue);
+        appendNumber(aFields, eDouble, apKey, &value);
+    }
+    template <typename T>
+    static void appendValue(Stream&, std::string& aFields, const char* apKey, const T& aValue,
+                            std::integral_constant<int, 4>) {
+        appendKey(aFields, eBool, apKey);
+        aFields.push_back(aValue ? 1 : 0);
+    }
+    /// @}
+
+    /// @brief Encode any other type as the string of its operator<<, formatted at the end of the text of the Stream
+    template <typename T>
+    static void appendString(Stream& aStream, std::string& aFields, const char* apKey, const T& aValue) {
+        // Use the buffer of the Stream instead of a std::ostringstream, then remove the value from the text
+        const size_t size = aStream.size();
+        aStream.appendDefault(aValue);
+        appendString(aFields, apKey, aStream.c_str() + size, aStream.size() - size);
+        aStream.truncate(size);
+    }
+    /// @{ Encode a string field
+    static void appendString(Stream&, std::string& aFields, const char* apKey, char aValue) {
+        appendString(aFields, apKey, &aValue, 1);
+    }
+    static void appendString(Stream&, std::string& aFields, const char* apKey, const char* apValue) {
+        appendString(aFields, apKey, apValue, (nullptr != apValue) ? strlen(apValue) : 0);
+    }
+    static void appendString(Stream&, std::string& aFields, const char* apKey, const std::string& aValue) {
+        appendString(aFields, apKey, aValue.data(), aValue.size());
+    }
+    static void appendString(std::string& aFields, const char* apKey, const char* apValue, size_t aSize);
+    /// @}
+
+    /// @brief Encode the type and the key of a field
+    static void appendKey(std::string& aFields, Type aType, const char* apKey);
+
+    /// @brief Encode a number field, from its 8 bytes representation
+    static void appendNumber(std::string& aFields, Type aType, const char* apKey, const void* apValue);
+
+private:
+    static std::atomic<unsigned int> mArgsOutputs;  ///< Number of Output objects formatting the messages themselves
+};
+
+
+} // namespace Log
@@ -0,0 +1,236 @@
+/**
+ * @file    Format.h
+ * @ingroup LoggerCpp
+ * @brief   Type-safe "{}" format strings, written straight into the Stream of a Log without iostreams
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <LoggerCpp/Stream.h>
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+
+
+namespace Log {
+
+
+/**
+ * @brief   Type-safe "{}" format strings, written straight into the Stream of a Log without iostreams
+ * @ingroup LoggerCpp
+ *
+ *  Each "{}" of the format string is replaced by the next argument, "{{" and "}}" are literal braces.
+ * A placeholder can specify a format "{:[align][0][width][.precision][type]}" where:
+ * - align is '<' (default for strings) or '>' (default for numbers), and '0' pads numbers with zeros,
+ * - type is 'd', 'x', 'X', 'o' or 'b' for integers, 'f', 'e' or 'g' (default) for floating points.
+ *
+ *  Integers are converted by hand, and floating points like the operator<< of the Log (snprintf() being left
+ * to the values with many significant digits, and to the 'e' type), without any std::ostream;
+ * any other type falls back to its operator<< on the Stream.
+ * A placeholder without argument, or with an invalid specification, is written as is, and extra arguments are ignored:
+ * use the LOGF_DEBUG() ... LOGF_CRITIC() macros to check the format string at compile time,
+ * with count() parsing the placeholders with the same grammar as write().
+ */
+class Format {
+public:
+    /// @brief Format specification of a placeholder
+    struct Spec {
+        char    align;      ///< '<' or '>', or '\0' for the default alignment of the type
+        char    fill;       ///< Padding character (' ' or '0')
+        char    type;       ///< Presentation type, or '\0' for the default of the type
+        size_t  width;      ///< Minimum width (0 for none)
+        int     precision;  ///< Precision of floating points (-1 for the default)
+    };
+
+    /// @brief Type-erased reference to an argument of a format string
+    class Arg {
+    public:
+        /// @brief Empty argument, terminating the list
+        Arg(void) :
+            mpValue(nullptr),
+            mpWrite(nullptr) {
+        }
+
+        /// @brief Reference to an argument
+        template <typename T>
+        explicit Arg(const T& aValue) :
+            mpValue(&aValue),
+            mpWrite(&Format::writeArg<T>) {
+        }
+
+        /// @brief Write the argument into the Stream
+        inline void write(Stream& aStream, const Spec& aSpec) const {
+            mpWrite(aStream, aSpec, mpValue);
+        }
+
+    private:
+        const void* mpValue;                                            ///< The argument
+        void      (*mpWrite)(Stream&, const Spec&, const void* apValue);  ///< Writer of the type of the argument
+    };
+
+    /**
+     * @brief Write a formatted message into the Stream
+     *
+     * @param[in,out] aStream   Stream of the Log
+     * @param[in]     apFormat  Format string, with "{}" placeholders
+     * @param[in]     aArgs     Arguments replacing the placeholders
+     */
+    template <typename... Args>
+    static void write(Stream& aStream, const char* apFormat, const Args&... aArgs) {
+        const Arg args[] = { Arg(aArgs)..., Arg() };
+        write(aStream, apFormat, args, sizeof...(Args));
+    }
+
+    /**
+     * @brief Write a formatted message into the Stream, with a list of type-erased arguments
+     *
+     * @param[in,out] aStream   Stream of the Log
+     * @param[in]     apFormat  Format string, with "{}" placeholders
+     * @param[in]     apArgs    Arguments replacing the placeholders
+     * @param[in]     aNbArgs   Number of arguments
+     */
+    static void write(Stream& aStream, const char* apFormat, const Arg* apArgs, size_t aNbArgs);
+
+    /// @brief Value returned by count() for an invalid format string
+    static const size_t INVALID = static_cast<size_t>(-1);
+
+    /**
+     * @brief Count the placeholders of a format string, at compile time
+     *
+     * @param[in] apFormat  Format string, with "{}" placeholders
+     *
+     * @return Number of placeholders, or INVALID if a brace is not closed or a specification is not valid
+     *         (a placeholder that write() would not replace, but output as is)
+     */
+    static constexpr size_t count(const char* apFormat) {
+        return ('\0' == apFormat[0]) ? 0 :
+               (('{' == apFormat[0]) && ('{' == apFormat[1])) ? count(apFormat + 2) :
+               (('}' == apFormat[0]) && ('}' == apFormat[1])) ? count(apFormat + 2) :
+               ('}' == apFormat[0]) ? INVALID :
+               ('{' != apFormat[0]) ? count(apFormat + 1) :
+               (nullptr == close(apFormat + 1)) ? INVALID : next(count(close(apFormat + 1) + 1));
+    }
+
+    /// @brief Declared only to count its arguments with sizeof(), in unevaluated context
+    template <typename... Args>
+    static char (&args(const Args&... aArgs))[sizeof...(Args)];  // NOLINT(whitespace/parens)
+
+private:
+    /**
+     * @brief Parse a placeholder "{:[align][0][width][.precision][type]}" at compile time, like Format.cpp
+     *
+     * @param[in] apFormat  The character following the opening brace
+     *
+     * @return The closing brace, or nullptr if the placeholder is invalid
+     */
+    static constexpr const char* close(const char* apFormat) {
+        return ('}' == *apFormat) ? apFormat : (':' == *apFormat) ? closeAlign(apFormat + 1) : nullptr;
+    }
+
+    /// @{ Parse each part of the specification of a placeholder, see close()
+    static constexpr const char* closeAlign(const char* apFormat) {
+        return closeFill((('<' == *apFormat) || ('>' == *apFormat)) ? apFormat + 1 : apFormat);
+    }
+    static constexpr const char* closeFill(const char* apFormat) {
+        return closeWidth(('0' == *apFormat) ? apFormat + 1 : apFormat);
+    }
+    static constexpr const char* closeWidth(const char* apFormat) {
+        return (('0' <= *apFormat) && ('9' >= *apFormat)) ? closeWidth(apFormat + 1) :
+               ('.' == *apFormat) ? closePrecision(apFormat + 1) : closeType(apFormat);
+    }
+    static constexpr const char* closePrecision(const char* apFormat) {
+        return (('0' <= *apFormat) && ('9' >= *apFormat)) ? closePrecision(apFormat + 1) : closeType(apFormat);
+    }
+    static constexpr const char* closeType(const char* apFormat) {
+        return closeBrace(isType(*apFormat) ? apFormat + 1 : apFormat);
+    }
+    static constexpr const char* closeBrace(const char* apFormat) {
+        return ('}' == *apFormat) ? apFormat : nullptr;
+    }
+    static constexpr bool isType(char aType) {
+        return ('d' == aType) || ('x' == aType) || ('X' == aType) || ('o' == aType) || ('b' == aType)
+            || ('f' == aType) || ('e' == aType) || ('g' == aType);
+    }
+    /// @}
+
+    /// @brief Add a placeholder to the count of the following ones
+    static constexpr size_t next(size_t aCount) {
+        return (INVALID == aCount) ? INVALID : aCount + 1;
+    }
+
+    /// @brief Write a type-erased argument (bool and char are not written as numbers)
+    template <typename T>
+    static void writeArg(Stream& aStream, const Spec& aSpec, const void* apValue) {
+        writeValue(aStream, aSpec, *static_cast<const T*>(apValue),
+                   std::integral_constant<int, std::is_floating_point<T>::value ? 3 :
+                                               !std::is_integral<T>::value ? 0 :
+                                               std::is_same<T, bool>::value ? 0 :
+                                               std::is_same<T, char>::value ? 0 :
+                                               std::is_signed<T>::value ? 1 : 2>());
+    }
+
+    /// @{ Write an argument according to its category
+    template <typename T>
+    static void writeValue(Stream& aStream, const Spec& aSpec, const T& aValue, std::integral_constant<int, 0>) {
+        writeStream(aStream, aSpec, aValue);
+    }
+    template <typename T>
+    static void writeValue(Stream& aStream, const Spec& aSpec, const T& aValue, std::integral_constant<int, 1>) {
+        const bool bNegative = (aValue < 0);
+        // Negate as unsigned to handle the minimum value of the type
+        const unsigned long long value = static_cast<unsigned long long>(static_cast<long long>(aValue));
+        writeInteger(aStream, aSpec, bNegative ? (0 - value) : value, bNegative);
+    }
+    template <typename T>
+    static void writeValue(Stream& aStream, const Spec& aSpec, const T& aValue, std::integral_constant<int, 2>) {
+        writeInteger(aStream, aSpec, static_cast<unsigned long long>(aValue), false);
+    }
+    template <typename T>
+    static void writeValue(Stream& aStream, const Spec& aSpec, const T& aValue, std::integral_constant<int, 3>) {
+        writeFloat(aStream, aSpec, static_cast<double>(aValue));
+    }
+    /// @}
+
+    /// @brief Write any other type with its operator<< on the Stream
+    template <typename T>
+    static void writeStream(Stream& aStream, const Spec& aSpec, const T& aValue) {
+        aStream.width(static_cast<std::streamsize>(aSpec.width));
+        aStream.fill(aSpec.fill);
+        aStream << aValue;
+        aStream.width(0);
+        aStream.fill(' ');
+    }
+    /// @{ Write the types that have a dedicated representation
+    static void writeStream(Stream& aStream, const Spec& aSpec, bool abValue);
+    static void writeStream(Stream& aStream, const Spec& aSpec, char aValue);
+    static void writeStream(Stream& aStream, const Spec& aSpec, const char* apValue);
+    static void writeStream(Stream& aStream, const Spec& aSpec, const std::string& aValue);
+    /// @}
+
+    /**
+     * @brief Write an integer, converted by hand
+     *
+     * @param[in,out] aStream       Stream of the Log
+     * @param[in]     aSpec         Format specification
+     * @param[in]     aValue        Absolute value
+     * @param[in]     abNegative    Sign of the value
+     */
+    static void writeInteger(Stream& aStream, const Spec& aSpec, unsigned long long aValue, bool abNegative);
+
+    /// @brief Write a floating point value, converted by the Stream (see Stream::toGeneral() and Stream::toFixed())
+    static void writeFloat(Stream& aStream, const Spec& aSpec, double aValue);
+
+    /// @brief Write a converted number, padded to the width of the specification (zeros go after the sign)
+    static void writeNumber(Stream& aStream, const Spec& aSpec, const char* apData, size_t aSize);
+
+    /// @brief Write characters, padded to the width of the specification
+    static void writePadded(Stream& aStream, const Spec& aSpec, char aDefaultAlign, const char* apData, size_t aSize);
+};
+
+
+} // namespace Log
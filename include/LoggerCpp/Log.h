@@ -10,18 +10,25 @@
  */
 #pragma once
 
+#include <LoggerCpp/Clock.h>
 #include <LoggerCpp/DateTime.h>
+#include <LoggerCpp/Fields.h>
+#include <LoggerCpp/Format.h>
+#include <LoggerCpp/Stream.h>
 #include <LoggerCpp/Utils.h>
 
-#include <sstream>
+#include <cstring>
+#include <string>
+#include <type_traits>
 #include <iomanip>  // For easy use of parametric manipulators (setfill, setprecision) by client code
 
 
 namespace Log {
 
 
-// forward declaration
+// forward declarations
 class Logger;
+class CallSite;
 
 
 /**
@@ -37,9 +44,16 @@ class Logger;
  *
  * It contains all required information for further formating, printing and transmitting
  * by the Logger class.
+ *
+ * The message is formatted into a Stream recycled by the current thread,
+ * so that building a Log does not allocate memory in steady state.
+ * Numbers, characters, strings and pointers are appended to it directly, without the locale and sentry
+ * of the std::ostream, as long as no manipulator (std::hex, std::setw...) changed its formatting state.
  */
 class Log {
     friend class Logger;
+    friend class AsyncQueue;
+    friend struct Manager;
 
 public:
     /**
@@ -58,7 +72,7 @@ public:
     /**
      * @brief stream inserter operator
      *
-     * @param[in] aValue    Value to be formatted and inserted into the Log string stream
+     * @param[in] aValue    Value to be formatted and inserted into the Log stream
      *
      * @return Currents Log instance 
      */
@@ -70,8 +84,124 @@ public:
         return (*this);
     }
 
+    /// @{ Insert a number, bypassing the std::ostream while the Stream is in its default formatting state
+    Log& operator<< (bool abValue)                  { return insertUnsigned(abValue); }
+    Log& operator<< (short aValue)                  { return insertSigned(aValue); }
+    Log& operator<< (unsigned short aValue)         { return insertUnsigned(aValue); }
+    Log& operator<< (int aValue)                    { return insertSigned(aValue); }
+    Log& operator<< (unsigned int aValue)           { return insertUnsigned(aValue); }
+    Log& operator<< (long aValue)                   { return insertSigned(aValue); }
+    Log& operator<< (unsigned long aValue)          { return insertUnsigned(aValue); }
+    Log& operator<< (long long aValue)              { return insertSigned(aValue); }
+    Log& operator<< (unsigned long long aValue)     { return insertUnsigned(aValue); }
+    Log& operator<< (float aValue)                  { return insertDouble(aValue); }
+    Log& operator<< (double aValue)                 { return insertDouble(aValue); }
+    /// @}
+
+    /// @brief Insert a character, bypassing the std::ostream when no width is set
+    Log& operator<< (char aValue) {
+        if (nullptr != mpStream) {
+            if (0 == mpStream->width()) {
+                mpStream->append(&aValue, 1);
+            } else {
+                *mpStream << aValue;
+            }
+        }
+        return (*this);
+    }
+
+    /// @brief Insert a string, bypassing the std::ostream when no width is set
+    Log& operator<< (const char* apValue) {
+        if (nullptr != mpStream) {
+            if ((0 == mpStream->width()) && (nullptr != apValue)) {
+                mpStream->append(apValue, strlen(apValue));
+            } else {
+                *mpStream << apValue;
+            }
+        }
+        return (*this);
+    }
+
+    /// @brief Insert a string, bypassing the std::ostream when no width is set
+    Log& operator<< (const std::string& aValue) {
+        if (nullptr != mpStream) {
+            if (0 == mpStream->width()) {
+                mpStream->append(aValue.data(), aValue.size());
+            } else {
+                *mpStream << aValue;
+            }
+        }
+        return (*this);
+    }
+
+    /// @brief Insert a pointer, bypassing the std::ostream while the Stream is in its default formatting state
+    ///        (character pointers are strings, and function pointers are manipulators like std::hex)
+    template <typename T>
+    typename std::enable_if<!std::is_function<T>::value && !std::is_same<typename std::remove_cv<T>::type, char>::value
+                            && !std::is_same<typename std::remove_cv<T>::type, signed char>::value
+                            && !std::is_same<typename std::remove_cv<T>::type, unsigned char>::value, Log&>::type
+    operator<< (T* apValue) {
+        if (nullptr != mpStream) {
+            if (mpStream->isDefault()) {
+                mpStream->appendPointer(apValue);
+            } else {
+                *mpStream << static_cast<const void*>(apValue);
+            }
+        }
+        return (*this);
+    }
+
     /**
-     * @brief Destructor : output the Log string stream
+     * @brief Insert a typed key/value field into the Log, see kv()
+     *
+     * @param[in] aKeyValue A key/value field made by kv()
+     *
+     * @return Currents Log instance
+     */
+    template <typename T>
+    Log& operator<< (const KeyValue<T>& aKeyValue) {
+        if (nullptr != mpStream) {
+            Fields::append(*mpStream, aKeyValue.mpKey, aKeyValue.mValue);
+        }
+        return (*this);
+    }
+
+    /**
+     * @brief Insert a message formatted from a "{}" format string into the Log stream, see Format
+     *
+     * @param[in] apFormat  Format string, with "{}" placeholders
+     * @param[in] aArgs     Arguments replacing the placeholders
+     *
+     * @return Currents Log instance
+     */
+    template <typename... Args>
+    Log& format(const char* apFormat, const Args&... aArgs) {
+        if (nullptr != mpStream) {
+            Format::write(*mpStream, apFormat, aArgs...);
+            // The format string of a LOGF_xxx() macro is known by its CallSite: keep the arguments for the OutputBinary
+            if ((nullptr != mpCallSite) && Fields::isArgsEncoded()) {
+                Fields::appendArgs(*mpStream, aArgs...);
+            }
+        }
+        return (*this);
+    }
+
+    /**
+     * @brief Insert a "suppressed" key/value field with the number of Log suppressed by a RateLimit, if any
+     *
+     * @param[in] aCount    Number of Log suppressed before this one (nothing is inserted for 0)
+     *
+     * @return Currents Log instance
+     */
+    Log& suppressed(long aCount) {
+        if ((nullptr != mpStream) && (0 < aCount)) {
+            Fields::append(*mpStream, "suppressed", aCount);
+        }
+        return (*this);
+    }
+
+    /**
+     * @brief Destructor : output the Log message
      */
     ~Log(void);
 
@@ -80,16 +210,112 @@ public:
         return mSeverity;
     }
 
-    /// @brief Timestamp of this Log
+    /// @brief Timestamp of this Log, converted from its raw stamp on the first call (see Clock)
     inline const DateTime& getTime(void) const {
+        if (!mbTime) {
+            mTime.set(Clock::toEpochNano(mStamp));
+            mbTime = true;
+        }
         return mTime;
     }
 
-    /// @brief The underlying string stream
-    inline const std::ostringstream& getStream(void) const {
-        return *mpStream;
+    /// @brief Timestamp of this Log in nanoseconds since the Epoch (UTC), without converting it to calendar fields
+    inline long long getEpochNano(void) const {
+        return mbTime ? (mTime.epoch * 1000000000LL + mTime.ns) : Clock::toEpochNano(mStamp);
+    }
+
+    /// @brief Raw stamp of this Log, captured by Clock::now()
+    inline long long getStamp(void) const {
+        return mStamp;
+    }
+
+    /// @brief The formatted message, null-terminated (zero-copy, valid only during the output of the Log)
+    inline const char* getMessage(void) const {
+        return mpMessage;
+    }
+
+    /// @brief Size of the formatted message
+    inline size_t getMessageSize(void) const {
+        return mMessageSize;
+    }
+
+    /// @brief Size of the text of the message, without the key/value fields rendered at its end
+    inline size_t getTextSize(void) const {
+        return mTextSize;
+    }
+
+    /// @brief The key/value fields, encoded by the Fields class (valid only during the output of the Log)
+    inline const char* getFields(void) const {
+        return mpFields;
+    }
+
+    /// @brief Size of the encoded key/value fields (0 if none)
+    inline size_t getFieldsSize(void) const {
+        return mFieldsSize;
+    }
+
+    /// @brief The arguments of the format string of its CallSite, encoded by Fields::appendArgs() (when output)
+    inline const char* getArgs(void) const {
+        return mpArgs;
+    }
+
+    /// @brief Size of the encoded arguments (0 if none, or if no Output asked for them, see Fields::isArgsEncoded())
+    inline size_t getArgsSize(void) const {
+        return mArgsSize;
+    }
+
+    /// @brief Source location of the LOG_xxx() macro that produced this Log (nullptr if not produced by a macro)
+    inline const CallSite* getCallSite(void) const {
+        return mpCallSite;
+    }
+
+    /// @brief Id of the thread that produced this Log, see getCurrentThreadId()
+    inline unsigned long getThreadId(void) const {
+        return mThreadId;
     }
 
+    /**
+     * @brief Id of the calling thread, as shown by the debuggers and system tools (the tid on Linux)
+     *
+     * Cached by each thread, so that only its first call is a system call.
+     */
+    static unsigned long getCurrentThreadId(void);
+
+    /// @brief Name of the thread that produced this Log, padded to THREAD_NAME_SIZE (nullptr if not named)
+    inline const char* getThreadName(void) const {
+        return mpThreadName;
+    }
+
+    /**
+     * @brief Name of the calling thread given by Manager::setThreadName(), padded with spaces to THREAD_NAME_SIZE
+     *
+     * Rendered once by setThreadName() and never freed, so that it is still valid once the thread has exited.
+     *
+     * @return The padded name, not null-terminated, or nullptr if the thread has not been named
+     */
+    static const char* getCurrentThreadName(void);
+
+    /// @brief Size of the name of a thread (longer names are truncated, like the names of the Linux threads)
+    static const size_t THREAD_NAME_SIZE = 15;
+
+    /// @brief Size of the date and time at the beginning of the text header, including the two spaces after them
+    static const size_t HEADER_TIME_SIZE = 25;
+
+    /**
+     * @brief The text header of the Log, "YYYY-MM-DD HH:MM:SS.mmm  Channel      LEVL ", rendered once for all Output
+     *
+     *  The header is rendered by the first Output asking for it, then shared by the others, which only
+     * have to write its bytes followed by the message (the syslog skips the date, which it adds itself).
+     * It is kept in a buffer of the thread dispatching the Log to the Output objects, instead of in the Log itself,
+     * and is recognized by the stamp, the Channel and the Level of the Log, the only inputs of its rendering.
+     *
+     * @param[in]  aChannelName Name of the underlying Channel of the Log
+     * @param[out] aSize        Size of the header (not null-terminated)
+     *
+     * @return The header, valid until the calling thread renders the header of another Log
+     */
+    const char* getHeader(const std::string& aChannelName, size_t& aSize) const;
+
     /**
      * @brief Convert a Level to its string representation
      *
@@ -117,16 +343,102 @@ private:
      */
     Log(const Logger& aLogger, Level aSeverity);
 
+    /**
+     * @brief Construct a RAII (private) log object for the Logger class, at the source location of a macro
+     *
+     * @param[in] aLogger   Reference to the parent Logger
+     * @param[in] aCallSite Source location, and severity of this Log
+     */
+    Log(const Logger& aLogger, const CallSite& aCallSite);
+
+    /**
+     * @brief Construct a copy of a Log replayed by the AsyncQueue writer thread, or a Log made by the Manager
+     *        (not output on destruction, and attributed to the calling thread)
+     *
+     * @param[in] aSeverity     Severity of this Log
+     * @param[in] aStamp        Raw stamp of this Log, captured by Clock::now()
+     * @param[in] apMessage     The formatted message of this Log, null-terminated
+     * @param[in] aMessageSize  Size of the formatted message
+     * @param[in] aTextSize     Size of the text of the message, without the rendered fields
+     * @param[in] apFields      The encoded key/value fields
+     * @param[in] aFieldsSize   Size of the encoded key/value fields
+     * @param[in] apArgs        The encoded arguments of the format string
+     * @param[in] aArgsSize     Size of the encoded arguments
+     * @param[in] apCallSite    Source location of this Log (or nullptr)
+     */
+    Log(Level aSeverity, long long aStamp, const char* apMessage, size_t aMessageSize, size_t aTextSize,
+        const char* apFields, size_t aFieldsSize, const char* apArgs, size_t aArgsSize, const CallSite* apCallSite);
+
+    /**
+     * @brief Set the name of the calling thread. Used only by Manager::setThreadName().
+     *
+     * @param[in] apName    Padded name, never freed (or nullptr)
+     */
+    static void setCurrentThreadName(const char* apName);
+
+    /// @brief Insert a signed integer, converted by hand in the default formatting state of the Stream
+    template <typename T>
+    Log& insertSigned(T aValue) {
+        if (nullptr != mpStream) {
+            if (mpStream->isDefault()) {
+                // Negate as unsigned to handle the minimum value of the type
+                const unsigned long long value = static_cast<unsigned long long>(static_cast<long long>(aValue));
+                mpStream->appendInteger((aValue < 0) ? (0 - value) : value, (aValue < 0));
+            } else {
+                *mpStream << aValue;
+            }
+        }
+        return (*this);
+    }
+
+    /// @brief Insert an unsigned integer (or a bool), converted by hand in the default formatting state of the Stream
+    template <typename T>
+    Log& insertUnsigned(T aValue) {
+        if (nullptr != mpStream) {
+            if (mpStream->isDefault()) {
+                mpStream->appendInteger(static_cast<unsigned long long>(aValue), false);
+            } else {
+                *mpStream << aValue;
+            }
+        }
+        return (*this);
+    }
+
+    /// @brief Insert a floating point value, converted without the locale in the default formatting state of the Stream
+    template <typename T>
+    Log& insertDouble(T aValue) {
+        if (nullptr != mpStream) {
+            if (mpStream->isDefault()) {
+                mpStream->appendDouble(static_cast<double>(aValue));
+            } else {
+                *mpStream << aValue;
+            }
+        }
+        return (*this);
+    }
+
     /// @{ Non-copyable object
     Log(const Log&);
     void operator=(const Log&);
     /// @}
 
 private:
-    const Logger&       mLogger;    ///< Reference to the parent Logger
-    Level               mSeverity;  ///< Severity of this Log
-    DateTime            mTime;      ///< Timestamp of the output
-    std::ostringstream* mpStream;   ///< The underlying string stream
+    const Logger*       mpLogger;       ///< Pointer to the parent Logger (nullptr for a replayed Log)
+    Level               mSeverity;      ///< Severity of this Log
+    long long           mStamp;         ///< Raw stamp of the output, captured by Clock::now()
+    mutable bool        mbTime;         ///< true once mTime has been converted from mStamp
+    mutable DateTime    mTime;          ///< Timestamp of the output, converted on demand by getTime()
+    Stream*             mpStream;       ///< The underlying stream (nullptr if the Log is disabled, or replayed)
+    const char*         mpMessage;      ///< The formatted message, null-terminated (when output)
+    size_t              mMessageSize;   ///< Size of the formatted message
+    size_t              mTextSize;      ///< Size of the text of the message, without the rendered fields
+    const char*         mpFields;       ///< The encoded key/value fields (when output)
+    size_t              mFieldsSize;    ///< Size of the encoded key/value fields
+    const char*         mpArgs;         ///< The encoded arguments of the format string (when output)
+    size_t              mArgsSize;      ///< Size of the encoded arguments
+    const CallSite*     mpCallSite;     ///< Source location of the Log (nullptr if not produced by a macro)
+    unsigned long       mThreadId;      ///< Id of the thread that produced the Log (when output)
+    const char*         mpThreadName;   ///< Padded name of the thread that produced the Log (or nullptr)
 };
 
 
@@ -11,11 +11,23 @@
 #pragma once
 
 #include <LoggerCpp/Log.h>
+#include <LoggerCpp/CallSite.h>
 #include <LoggerCpp/Channel.h>
+#include <LoggerCpp/RateLimit.h>
 
 #include <string>
 
 
+/// @{ Branch prediction hints (GCC and Clang only), the Log macros all using LOGGER_LIKELY(!enabled)
+#if defined(__GNUC__) || defined(__clang__)
+#define LOGGER_LIKELY(x)    __builtin_expect(!!(x), 1)
+#define LOGGER_UNLIKELY(x)  __builtin_expect(!!(x), 0)
+#else
+#define LOGGER_LIKELY(x)    (x)
+#define LOGGER_UNLIKELY(x)  (x)
+#endif
+/// @}
+
 /**
  * @brief   LoggerC++ (LoggerCpp) is a simple, elegant and efficient C++ logger library.
  * @ingroup LoggerCpp
@@ -27,14 +39,19 @@ namespace Log {
  * @brief   A simple thread-safe logger class
  * @ingroup LoggerCpp
  *
- *  Logger is designed to be easy to use, light (size of a shared_ptr) and efficient.
+ *  Logger is designed to be easy to use, light (two pointers) and efficient.
  * It can be used as a member variable, and will not consume much CPU
  * if the log severity is below the Logger current Log::Level.
  *
+ *  A Logger is a handle to its Channel in the table of the Manager, where a Channel is never freed:
+ * it is trivially copyable, without any reference counting. Only its construction by name looks the Channel up,
+ * so the objects having a Logger member should copy it from a StaticLogger, see LOGGER_DECLARE().
+ *
  * @note A Logger object is copyable without any limitations
  */
 class Logger {
     friend class Log;
+    friend class StaticLogger;
 
 public:
     /**
@@ -43,12 +60,8 @@ public:
      * @param[in] apChannelName    String to identify origin of Log output by this Logger
      */
     explicit Logger(const char* apChannelName);
-    /**
-     * @brief Non virtual destructor
-     */
-    ~Logger(void);
 
-    // A Logger is copyable with its a default copy constructor and copy operator without any problem
+    // A Logger is trivially copyable, and trivially destructible
 
     /// @{ Utility const method to produce Log objets, used to collect the stream to output
     Log debug(void) const;
@@ -59,22 +72,124 @@ public:
     Log critic(void) const;
     /// @}
 
+    /**
+     * @brief Produce a Log at the source location of a LOG_xxx() macro, with the Level of its CallSite
+     *
+     * @param[in] aCallSite Static CallSite declared by the macro
+     */
+    Log log(const CallSite& aCallSite) const;
+
+    /**
+     * @brief Produce a Log at the source location of a LOGF_xxx() macro, with a "{}" format string, see Format
+     *
+     * @param[in] aCallSite Static CallSite declared by the macro
+     * @param[in] apFormat  Format string, with "{}" placeholders
+     * @param[in] aArgs     Arguments replacing the placeholders
+     */
+    template <typename... Args>
+    void log(const CallSite& aCallSite, const char* apFormat, const Args&... aArgs) const {
+        Log(*this, aCallSite).format(apFormat, aArgs...);
+    }
+
+    /**
+     * @brief Produce a Log of the given Level with a "{}" format string, bypassing the std::ostream, see Format
+     *
+     *  The format string is not checked at compile time (an invalid placeholder, or one without argument,
+     * is output as is): use the LOGF_DEBUG() ... LOGF_CRITIC() macros for that.
+     *
+     * @param[in] aLevel    Severity Level of the Log
+     * @param[in] apFormat  Format string, with "{}" placeholders
+     * @param[in] aArgs     Arguments replacing the placeholders
+     */
+    template <typename... Args>
+    void log(Log::Level aLevel, const char* apFormat, const Args&... aArgs) const {
+        if (isEnabled(aLevel)) {
+            Log(*this, aLevel).format(apFormat, aArgs...);
+        }
+    }
+
+    /// @{ Utility const method to produce Log objets with a "{}" format string, see log()
+    template <typename... Args>
+    void debug(const char* apFormat, const Args&... aArgs) const {
+        log(Log::eDebug, apFormat, aArgs...);
+    }
+    template <typename... Args>
+    void info(const char* apFormat, const Args&... aArgs) const {
+        log(Log::eInfo, apFormat, aArgs...);
+    }
+    template <typename... Args>
+    void notice(const char* apFormat, const Args&... aArgs) const {
+        log(Log::eNotice, apFormat, aArgs...);
+    }
+    template <typename... Args>
+    void warning(const char* apFormat, const Args&... aArgs) const {
+        log(Log::eWarning, apFormat, aArgs...);
+    }
+    template <typename... Args>
+    void error(const char* apFormat, const Args&... aArgs) const {
+        log(Log::eError, apFormat, aArgs...);
+    }
+    template <typename... Args>
+    void critic(const char* apFormat, const Args&... aArgs) const {
+        log(Log::eCritic, apFormat, aArgs...);
+    }
+    /// @}
+
     /// @brief Name of the underlying Channel
     inline const std::string& getName(void) const {
-        return mChannelPtr->getName();
+        return mpChannel->getName();
     }
 
     /// @brief Set the current output Log::Level of the underlying Channel
     inline void setLevel(Log::Level aLevel) {
-        mChannelPtr->setLevel(aLevel);
+        mpChannel->setLevel(aLevel);
     }
 
     /// @brief Current Log::Level of the underlying Channel
     inline Log::Level getLevel(void) const {
-        return mChannelPtr->getLevel();
+        return mpChannel->getLevel();
+    }
+
+    /// @brief Tell if a Log of the given Log::Level would be output by the underlying Channel
+    inline bool isEnabled(Log::Level aLevel) const {
+        return (aLevel >= mpChannel->getLevel());
+    }
+
+    /**
+     * @brief Tell if a Log of the given CallSite would be output: by its State, or else by the underlying Channel
+     *
+     *  Registers the CallSite on its first execution (applying the rules of Manager::setCallSites() to it).
+     *
+     * @param[in] aCallSite Static CallSite declared by a LOG_xxx() macro
+     */
+    inline bool isEnabled(const CallSite& aCallSite) const {
+        const CallSite::State state = aCallSite.getState();
+        if (LOGGER_LIKELY(CallSite::eDefault == state)) {
+            return isEnabled(aCallSite.getLevel());
+        }
+        return (CallSite::eEnabled == state) || ((CallSite::eUnregistered == state) && registerCallSite(aCallSite));
     }
 
 private:
+    /**
+     * @brief Initialize a Logger from its Channel in the table of the Manager. Used only by StaticLogger.
+     *
+     * @param[in] aChannelPtr   Shared pointer to the Channel, as stored in the table of the Manager (never freed)
+     */
+    explicit Logger(const Channel::Ptr& aChannelPtr) :
+        mpChannel(aChannelPtr.get()),
+        mpChannelPtr(&aChannelPtr) {
+    }
+
+    /**
+     * @brief Register a CallSite on its first execution, see isEnabled()
+     *
+     * @param[in] aCallSite Static CallSite declared by a LOG_xxx() macro
+     *
+     * @return true if a Log of the CallSite would be output
+     */
+    bool registerCallSite(const CallSite& aCallSite) const;
+
     /**
      * @brief Output the Log. Used only by the Log class destructor.
      *
@@ -83,9 +198,124 @@ private:
     void output(const Log& aLog) const;
 
 private:
-    Channel::Ptr  mChannelPtr;   ///< Shared pointer to the underlying Channel
+    Channel*            mpChannel;      ///< The underlying Channel, read by the inlined Level checks
+    const Channel::Ptr* mpChannelPtr;   ///< Shared pointer to the underlying Channel, in the table of the Manager
 };
 
 
 } // namespace Log
 
+
+/**
+ * @def     LOGGERCPP_MIN_LEVEL
+ * @brief   Minimum Log::Level compiled in by the LOG_DEBUG() ... LOG_CRITIC() macros
+ * @ingroup LoggerCpp
+ *
+ * Define it at build time (for instance -DLOGGERCPP_MIN_LEVEL=2 for Notice) to compile out
+ * all the Log statements below this Level. Default (0) keeps all of them.
+ */
+#ifndef LOGGERCPP_MIN_LEVEL
+#define LOGGERCPP_MIN_LEVEL 0
+#endif
+
+/**
+ * @brief Produce a Log only if its Level is enabled, without evaluating any of its operands otherwise
+ *
+ *  Unlike logger.debug() << expensive(), LOG_DEBUG(logger) << expensive() does only one inlined level check
+ * when the Log is disabled: no function call, no Log object, and the operands are never evaluated.
+ * Below LOGGERCPP_MIN_LEVEL, the condition is a compile-time constant and the whole statement is compiled out.
+ *
+ * The Log carries the source location of the macro, a static constexpr CallSite declared in the init-statement
+ * of a "for" run once: the "if {} else" and "for" forms keep the macro safe to use in an unbraced if/else statement.
+ * The State of this CallSite is checked first, so that Manager::setCallSites() can enable or disable it at runtime.
+ *
+ * @param[in] logger    Logger object to use
+ * @param[in] level     Log::Level of the Log, as an enum value without scope (eDebug, eInfo...)
+ */
+#define LOGGER_LOG(logger, level) \
+    if (::Log::Log::level < LOGGERCPP_MIN_LEVEL) {} \
+    else for (bool loggerOnce_ = true; loggerOnce_; ) /* NOLINT */ \
+        for (static constexpr ::Log::CallSite loggerCallSite_(__FILE__, __LINE__, __func__, ::Log::Log::level); \
+             loggerOnce_; loggerOnce_ = false) \
+            if (LOGGER_LIKELY(!(logger).isEnabled(loggerCallSite_))) {} /* NOLINT */ \
+            else (logger).log(loggerCallSite_) /* NOLINT */
+
+/// @{ Produce a Log of the corresponding Level only if it is enabled, see LOGGER_LOG()
+#define LOG_DEBUG(logger)   LOGGER_LOG(logger, eDebug)
+#define LOG_INFO(logger)    LOGGER_LOG(logger, eInfo)
+#define LOG_NOTICE(logger)  LOGGER_LOG(logger, eNotice)
+#define LOG_WARNING(logger) LOGGER_LOG(logger, eWarning)
+#define LOG_ERROR(logger)   LOGGER_LOG(logger, eError)
+#define LOG_CRITIC(logger)  LOGGER_LOG(logger, eCritic)
+/// @}
+
+/**
+ * @brief Produce a Log only if its Level is enabled, and if its call site is within the given rate, see RateLimit
+ *
+ *  Each call site has its own static RateLimit token bucket: a suppressed Log costs no more than
+ * a clock read and two atomic operations, and its operands are never evaluated.
+ * The next Log allowed carries a "suppressed" key/value field with the number of Log suppressed before it.
+ *
+ * The "for" form declares the result of the RateLimit in the scope of the statement only,
+ * and keeps the macro safe to use in an unbraced if/else statement.
+ *
+ * @param[in] logger    Logger object to use
+ * @param[in] level     Log::Level of the Log, as an enum value without scope (eDebug, eInfo...)
+ * @param[in] rate      Number of Log per second allowed in the long run for this call site
+ * @param[in] burst     Number of Log allowed at once for this call site
+ */
+#define LOGGER_LOG_LIMIT(logger, level, rate, burst) \
+    for (bool loggerOnce_ = (::Log::Log::level >= LOGGERCPP_MIN_LEVEL); loggerOnce_; ) /* NOLINT */ \
+        for (static constexpr ::Log::CallSite loggerCallSite_(__FILE__, __LINE__, __func__, ::Log::Log::level); \
+             loggerOnce_; loggerOnce_ = false) \
+            for (long loggerSuppressed_ = LOGGER_LIKELY(!(logger).isEnabled(loggerCallSite_)) ? -1 : \
+                    [&]() -> long { static ::Log::RateLimit sRateLimit(rate, burst); return sRateLimit.acquire(); }(); \
+                 0 <= loggerSuppressed_; loggerSuppressed_ = -1) \
+                (logger).log(loggerCallSite_).suppressed(loggerSuppressed_)
+
+/// @{ Produce a Log of the corresponding Level only if it is enabled and within the rate, see LOGGER_LOG_LIMIT()
+#define LOG_DEBUG_LIMIT(logger, rate, burst)    LOGGER_LOG_LIMIT(logger, eDebug,    rate, burst)
+#define LOG_INFO_LIMIT(logger, rate, burst)     LOGGER_LOG_LIMIT(logger, eInfo,     rate, burst)
+#define LOG_NOTICE_LIMIT(logger, rate, burst)   LOGGER_LOG_LIMIT(logger, eNotice,   rate, burst)
+#define LOG_WARNING_LIMIT(logger, rate, burst)  LOGGER_LOG_LIMIT(logger, eWarning,  rate, burst)
+#define LOG_ERROR_LIMIT(logger, rate, burst)    LOGGER_LOG_LIMIT(logger, eError,    rate, burst)
+#define LOG_CRITIC_LIMIT(logger, rate, burst)   LOGGER_LOG_LIMIT(logger, eCritic,   rate, burst)
+/// @}
+
+/// @brief First argument of a list of macro arguments (portable with a single argument)
+#define LOGGER_FIRST(...)           LOGGER_FIRST_(__VA_ARGS__, unused)
+/// @brief Implementation of LOGGER_FIRST()
+#define LOGGER_FIRST_(first, ...)   first
+
+/**
+ * @brief Produce a Log with a "{}" format string only if it is enabled, checking the format string at compile time
+ *
+ * The format string must be a string literal, its placeholders must be valid,
+ * and their number must match the number of arguments.
+ *
+ * @param[in] logger    A Log::Logger
+ * @param[in] level     A Log::Level, without the namespace (eDebug, eInfo, ...)
+ * @param[in] ...       The format string (a string literal), followed by its arguments
+ */
+#define LOGGER_LOGF(logger, level, ...) \
+    do { \
+        static_assert(::Log::Format::count(LOGGER_FIRST(__VA_ARGS__)) != ::Log::Format::INVALID, \
+                      "the format string has an invalid placeholder or an unescaped brace"); \
+        static_assert(::Log::Format::count(LOGGER_FIRST(__VA_ARGS__)) \
+                      == sizeof(::Log::Format::args(__VA_ARGS__)) - 1, \
+                      "the number of arguments does not match the placeholders of the format string"); \
+        static constexpr ::Log::CallSite loggerCallSite_(__FILE__, __LINE__, __func__, ::Log::Log::level, \
+                                                         LOGGER_FIRST(__VA_ARGS__)); \
+        if ((::Log::Log::level < LOGGERCPP_MIN_LEVEL) || LOGGER_LIKELY(!(logger).isEnabled(loggerCallSite_))) {} \
+        else (logger).log(loggerCallSite_, __VA_ARGS__); /* NOLINT */ \
+    } while (0)
+
+/// @{ Produce a Log of the corresponding Level with a "{}" format string checked at compile time, see LOGGER_LOGF()
+#define LOGF_DEBUG(logger, ...)     LOGGER_LOGF(logger, eDebug,     __VA_ARGS__)
+#define LOGF_INFO(logger, ...)      LOGGER_LOGF(logger, eInfo,      __VA_ARGS__)
+#define LOGF_NOTICE(logger, ...)    LOGGER_LOGF(logger, eNotice,    __VA_ARGS__)
+#define LOGF_WARNING(logger, ...)   LOGGER_LOGF(logger, eWarning,   __VA_ARGS__)
+#define LOGF_ERROR(logger, ...)     LOGGER_LOGF(logger, eError,     __VA_ARGS__)
+#define LOGF_CRITIC(logger, ...)    LOGGER_LOGF(logger, eCritic,    __VA_ARGS__)
+/// @}
+
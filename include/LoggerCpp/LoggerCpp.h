@@ -20,6 +20,7 @@
 // Include useful headers of LoggerC++
 #include <LoggerCpp/Logger.h>
 #include <LoggerCpp/Manager.h>
+#include <LoggerCpp/StaticLogger.h>
 
 
 /**
@@ -11,9 +11,16 @@
 #pragma once
 
 #include <LoggerCpp/Log.h>
+#include <LoggerCpp/CallSite.h>
 #include <LoggerCpp/Channel.h>
 #include <LoggerCpp/Output.h>
 #include <LoggerCpp/Config.h>
+#include <LoggerCpp/AsyncQueue.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
 
 
 namespace Log {
@@ -25,72 +32,369 @@ namespace Log {
  *
  *  The Manager keeps a map of all the named Channel objects
  * and share them on demand by new Logger objects created with the same name.
+ * This map is split into shards, each protected by its own mutex,
+ * so that Logger objects can be created concurrently by any thread with little contention.
  *
  *  Thus the Manager is able to change the Log::Level of selected Channel object,
  * impacting all the Logger objects using it.
  *
  * The Manager also keeps a list of all configured Output object to output the Log objects.
+ * This list is immutable once published: configure() publishes a new one, so that logging threads
+ * never take a lock to read it, and never see it being modified.
+ *
+ *  By default, Log objects are output synchronously by the thread that produced them.
+ * Once configureAsync() has been called, they are instead copied into an AsyncQueue
+ * and output by a background writer thread.
  */
 struct Manager {
+    friend class AsyncQueue;
+
 public:
     /**
      * @brief Create and configure the Output objects.
      *
+     * Replace the current Output objects by the new ones. Thread-safe: can be called at any time,
+     * while other threads are logging. The replaced Output objects are flushed and destroyed
+     * as soon as no other thread is using them anymore (which is waited for, without blocking the logging threads).
+     *
      * @see setChannelConfig()
      *
-     * @param[in] aConfigList   List of Config for Output objects
+     * Each Output accepts the following routing options in its Config:
+     * - "level" : minimum Log::Level of the Log output (default "DBUG")
+     * - "channels" : comma separated list of the Channel names output, with '*' and '?' wildcards (default "*")
+     *
+     * The routing is precomputed into a bitmask of the Output objects for each Channel,
+     * so that a Log is only given to the Output objects wanting it.
+     *
+     * The first call also starts a background thread ticking the Output objects every TICK_PERIOD,
+     * to apply their time based conditions (see OutputFile "flush_period"), until terminate().
+     *
+     * @param[in] aConfigList   List of Config for Output objects (at most 48)
      */
     static void         configure(const Config::Vector& aConfigList);
 
+    /**
+     * @brief Switch to asynchronous output of Log objects, by a background writer thread.
+     *
+     * The Config of the AsyncQueue accepts the following options:
+     * - "queue_size" : maximum number of pending Log (rounded up to a power of two, default 8192)
+     * - "overflow" : policy when the queue is full, "block" (default), "drop_newest" or "drop_debug_first"
+     * - "mode" : "shared" (default) for a single queue, or "per_thread" for one queue of "queue_size" per thread,
+     *            merged by timestamp by the writer thread
+     * - "merge_window" : in "per_thread" mode, maximum delay in milliseconds to wait for a Log of an idle thread
+     *                    before outputting the newer ones of the other threads (default 10)
+     *
+     * @param[in] aConfigPtr    Config of the AsyncQueue
+     */
+    static void         configureAsync(const Config::Ptr& aConfigPtr);
+
+    /**
+     * @brief Wait until all the Log produced before this call have been output, and written by their Output.
+     *
+     * Report the pending repetitions of the Channel objects collapsing identical consecutive Log,
+     * and the number of Log sampled out by the Channel objects sampling them,
+     * then in asynchronous mode, wait for the writer thread to output all pending Log,
+     * and ask each Output to write the Log it has buffered (see OutputFile "flush_size").
+     */
+    static void         flush(void);
+
+    /**
+     * @brief Number of Log of the given Level dropped because of the overflow policy of the AsyncQueue
+     *
+     * @param[in] aLevel    Log severity Level
+     *
+     * @return Number of Log dropped since configureAsync()
+     */
+    static unsigned long getDroppedCount(Log::Level aLevel);
+
+    /**
+     * @brief Number of Log lost by the current Output objects because of a failure to write them
+     *
+     * @see Output::getFailedCount(), for instance the transactions of OutputSqlite rolled back
+     *
+     * @return Number of Log lost since the current Output objects were configured
+     */
+    static unsigned long getFailedCount(void);
+
     /**
      * @brief Destroy the Output objects.
      * 
-     * Clear the Output list to release the ownership.
+     * Stop the ticking thread, flush and stop the asynchronous writer thread if any,
+     * then clear the Output list to release the ownership.
+     *
+     * @note No other thread shall be logging anymore when calling terminate().
      */
     static void         terminate(void);
 
     /**
      * @brief Return the Channel corresponding to the provided name
      *
-     * Create a new Channel or get the existing one. 
+     * Create a new Channel or get the existing one. Thread-safe.
      *
      * @param[in] apChannelName String to identify the underlying Channel of a Logger
      *
-     * @return Pointer to the corresponding Channel (never nullptr)
+     * @return Pointer to the corresponding Channel (never nullptr), stored in a table never freed
      */
-    static Channel::Ptr get(const char* apChannelName);
+    static const Channel::Ptr& get(const char* apChannelName);
 
     /**
      * @brief Output the Log to all the active Output objects.
      *
      * Dispatch the Log to OutputConsole/OutputFile/OutputVS/OutputMemory...
+     * or push it to the AsyncQueue of the writer thread in asynchronous mode.
      *
-     * @param[in] aChannelPtr   The underlying Channel of the Log
+     * @param[in] aChannelPtr   The underlying Channel of the Log, as referenced by get() (not a copy: queued by address)
      * @param[in] aLog          The Log to output
      */
     static void         output(const Channel::Ptr& aChannelPtr, const Log& aLog);
 
+    /**
+     * @brief Register a CallSite on its first execution, giving it its unique id and its State. Used only by Logger.
+     *
+     * @param[in] aCallSite     The static CallSite of a LOG_xxx() macro
+     * @param[in] aChannelName  Name of the Channel of the Logger executing it
+     */
+    static void         registerCallSite(const CallSite& aCallSite, const std::string& aChannelName);
+
+    /**
+     * @brief The CallSite of the LOG_xxx() macros executed since startup, in order of their id
+     *
+     * @return List of pointers to the static CallSite objects (valid as long as the code declaring them is loaded)
+     */
+    static std::vector<const CallSite*> getCallSites(void);
+
+    /**
+     * @brief The CallSite of the LOG_xxx() macros executed since startup matching a query, see setCallSites()
+     *
+     * @param[in] apQuery       Space separated "key=value" selectors, all of which must match
+     *
+     * @return List of pointers to the static CallSite objects, in order of their id
+     */
+    static std::vector<const CallSite*> getCallSites(const char* apQuery);
+
+    /**
+     * @brief Enable or disable the LOG_xxx() macros matching a query at runtime, whatever the Level of their Logger
+     *
+     *  The query is made of space separated "key=value" selectors, all of which must match (an empty query matches all):
+     * - "file=GLOB" the source file name (or its full path if the pattern contains a '/'), like "file=Main*.cpp"
+     * - "function=GLOB" the function
+     * - "line=N" or "line=N-M" the line, or a range of lines
+     * - "channel=GLOB" the Channel of the first Logger having executed the call site
+     *
+     *  The query is also kept to be applied to the call sites executed later for the first time,
+     * so it can be set at startup (the latest matching query giving its State to a call site).
+     * Setting the same query again replaces it. Thread-safe.
+     *
+     * @param[in] apQuery       Space separated "key=value" selectors
+     * @param[in] aState        CallSite::eEnabled, CallSite::eDisabled, or CallSite::eDefault to follow the Logger again
+     *
+     * @return Number of call sites executed since startup matching the query
+     *
+     * @throw Exception on an unknown selector
+     */
+    static size_t       setCallSites(const char* apQuery, CallSite::State aState);
+
+    /**
+     * @brief Name the calling thread, so that its Log are tagged with this name by the "%T" directive of a pattern
+     *
+     *  The name is truncated and padded with spaces to Log::THREAD_NAME_SIZE characters once, kept for good
+     * in a fixed table of MAX_THREAD_NAMES distinct names shared by all the threads of the same name,
+     * and cached by the thread: its Log only carry a pointer to it, without any system call.
+     * Once the table is full, a new name is not kept, and the Log of the thread are tagged with its id instead.
+     * On Linux, the name is also given to the system thread, as shown by the debuggers and "top -H".
+     * Thread-safe.
+     *
+     * @param[in] apName        Name of the thread (an empty name reverts to its id)
+     *
+     * @return false if the name could not be kept because the table is full (the thread is tagged with its id)
+     */
+    static bool         setThreadName(const char* apName);
+
+    /// @brief Maximum number of distinct thread names kept by setThreadName()
+    static const size_t MAX_THREAD_NAMES = 256;
+
     /**
      * @brief Set the default output Log::Level of any new Channel
      */
     static inline void setDefaultLevel(Log::Level aLevel) {
-        mDefaultLevel = aLevel;
+        mDefaultLevel.store(aLevel, std::memory_order_relaxed);
     }
 
     /**
-     * @brief Serialize the current Log::Level of Channel objects and return them as a Config instance
+     * @brief Serialize the current Log::Level and options of Channel objects and return them as a Config instance
      */
     static Config::Ptr getChannelConfig(void);
 
     /**
-     * @brief Set the Log::Level of Channel objects from the provided Config instance
+     * @brief Set the Log::Level and options of Channel objects from the provided Config instance
+     *
+     * Each value is a Log::Level optionally followed by space-separated "key=value" options:
+     * - "collapse=1" : collapse identical consecutive Log into a "last message repeated N times" Log
+     *                  (pending repetitions are reported on the next different Log, or by flush())
+     * - "sample=N" or "sample=p" : keep only 1 in N Log, or each Log with the probability p (0 < p < 1)
+     * - "sample_below=LEVEL" : Level below which Log are sampled (default "WARN")
+     * - "sample_period=S" : seconds between the "sampled out N Log" reports (default 60, 0 only on flush()),
+     *                       checked on each Log of the Channel and every second, so that an idle Channel reports too
+     *
+     * for instance setValue("Main.Network", "WARN collapse=1"). Options not specified are reset to their default.
+     * Thread-safe: can be called at any time, while other threads are logging.
+     *
+     * @throw Exception on an unknown option
      */
     static void setChannelConfig(const Config::Ptr& aConfigPtr);
 
+public:
+    /// @brief Period in milliseconds of the tick of the Output objects, see Output::tick()
+    static const long       TICK_PERIOD = 100;
+
+private:
+    /**
+     * @brief Push the Log to the AsyncQueue in asynchronous mode, or else dispatch it to the Output objects.
+     *
+     * @param[in] aChannelPtr   The underlying Channel of the Log, in the table of the Manager (referenced by the queue)
+     * @param[in] aLog          The Log to output
+     */
+    static void         send(const Channel::Ptr& aChannelPtr, const Log& aLog);
+
+    /**
+     * @brief Output a "last message repeated N times" Log, see Channel::setCollapse()
+     *
+     * @param[in] aChannelPtr   The Channel collapsing the repeated Log
+     * @param[in] aLevel        Level of the repeated Log
+     * @param[in] aRepeated     Number of repetitions of the Log
+     */
+    static void         outputRepeated(const Channel::Ptr& aChannelPtr, Log::Level aLevel, long aRepeated);
+
+    /**
+     * @brief Output a "sampled out N Log" report, see Channel::setSampling()
+     *
+     * @param[in] aChannelPtr   The Channel sampling its Log
+     * @param[in] aSampledOut   Number of Log sampled out since the last report
+     */
+    static void         outputSampledOut(const Channel::Ptr& aChannelPtr, long aSampledOut);
+
+    /**
+     * @brief Dispatch the Log to all the active Output objects (in the thread calling it).
+     *
+     * @param[in] aChannelPtr   The underlying Channel of the Log
+     * @param[in] aLog          The Log to output
+     */
+    static void         dispatch(const Channel::Ptr& aChannelPtr, const Log& aLog);
+
+    /**
+     * @brief Write the Log buffered by the provided Output objects.
+     *
+     * @param[in] aOutputList   List of Output objects to flush
+     */
+    static void         flush(const Output::Vector& aOutputList);
+
+    /**
+     * @brief Report the pending repetitions and the number of Log sampled out of the Channel objects
+     *
+     * @param[in] abFlush   Report all of them now (flush()), or only the Log sampled out due for a report (tick())
+     */
+    static void         report(bool abFlush);
+
+    /// @brief Tick the current Output objects, see Output::tick(), and report the Log sampled out (in the ticking thread)
+    static void         tick(void);
+
+private:
+    /// @brief A shard of the map of Channel objects
+    struct ChannelShard {
+        std::mutex      mMutex;     ///< Mutex protecting the map of the shard
+        Channel::Map    mMap;       ///< Map of shared pointer of Channel objects of the shard
+    };
+
+    /// @brief Number of shards of the map of Channel objects (a power of two)
+    static const size_t     CHANNEL_SHARDS = 16;
+
+    /// @brief Number of stripes of the counters of the threads reading the list of Output objects (a power of two)
+    static const size_t     READER_STRIPES = 16;
+
+    /// @brief Maximum number of Output objects (the bits of a route below its generation tag, see Channel::getRoutes())
+    static const size_t     MAX_OUTPUTS = 48;
+
+    /// @brief An immutable list of Output objects, with the routing of the Log to them
+    struct OutputList {
+        Output::Vector              mOutputs;               ///< The Output objects
+        std::vector<std::string>    mChannels;              ///< "channels" glob patterns of each Output
+        unsigned long long          mLevelRoutes[6];        ///< Output objects accepting each Log::Level, as bits
+        unsigned long long          mTag;                   ///< Generation of the list, tagging the routes
+
+        /// @brief Compute the route of a Channel : its generation tag and the bits of the Output objects matching it
+        unsigned long long route(const std::string& aChannelName) const;
+    };
+
+    /// @brief Counters of the threads reading a list of Output objects, each stripe on its own cache line
+    struct ReaderCount {
+        std::atomic<long>           mCount[2];              ///< Readers registered in an even or an odd epoch
+        char                        mPadding[64 - 2 * sizeof(std::atomic<long>)];  ///< Keep the stripes apart
+    };
+
+    /// @brief Protect the current list of Output objects from reclaim() while reading it (defined in Manager.cpp)
+    class ListReader;
+
+    /// @brief A query of setCallSites(), selecting call sites by file, function, line range and Channel
+    struct CallSiteQuery {
+        /**
+         * @brief Parse a query of space separated "key=value" selectors
+         *
+         * @param[in] apQuery   Text of the query
+         * @param[in] aState    State given to the matching call sites
+         *
+         * @throw Exception on an unknown selector
+         */
+        CallSiteQuery(const char* apQuery, CallSite::State aState);
+
+        /// @brief Tell if a registered CallSite, executed first by the given Channel, matches the query
+        bool match(const CallSite& aCallSite, const std::string& aChannelName) const;
+
+        std::string     mQuery;     ///< Text of the query
+        std::string     mFile;      ///< "file" glob pattern
+        std::string     mFunction;  ///< "function" glob pattern
+        std::string     mChannel;   ///< "channel" glob pattern
+        int             mFirstLine; ///< First line of the "line" range
+        int             mLastLine;  ///< Last line of the "line" range
+        CallSite::State mState;     ///< State given to the matching call sites
+    };
+
+    /// @brief The background thread ticking the Output objects every TICK_PERIOD (defined in Manager.cpp)
+    struct Ticker;
+
+    /// @brief The shards of the map of Channel objects, allocated on first use and never freed
+    static ChannelShard* getChannelShards(void);
+
+    /**
+     * @brief Queue a replaced list, to be destroyed by reclaim()
+     *
+     * @param[in] apOutputList  List of Output objects replaced in mpOutputList (with mConfigMutex locked)
+     */
+    static void         retire(const OutputList* apOutputList);
+
+    /**
+     * @brief Wait until no thread reads the retired lists anymore, then flush and destroy their Output objects
+     *
+     * Called without mConfigMutex locked, so that an Output flushed or destroyed here can use the Manager.
+     */
+    static void         reclaim(void);
+
 private:
-    static Channel::Map     mChannelMap;    ///< Map of shared pointer of Channel objects
-    static Output::Vector   mOutputList;    ///< List of Output objects
-    static Log::Level       mDefaultLevel;  ///< Default Log::Level of any new Channel
+    static std::atomic<const OutputList*>       mpOutputList;   ///< Current list of Output objects (or nullptr)
+    static ReaderCount                          mReaders[READER_STRIPES];   ///< Threads reading the list, by stripe
+    static std::atomic<unsigned long>           mEpoch;         ///< Advanced twice by each grace period of reclaim()
+    static std::mutex                           mConfigMutex;   ///< Mutex serializing configure() and terminate()
+    static std::vector<const OutputList*>       mRetiredLists;  ///< Lists replaced, not yet destroyed by reclaim()
+    static std::recursive_mutex                 mReclaimMutex;  ///< Mutex serializing the grace periods of reclaim()
+    static std::atomic<AsyncQueue*>             mpAsyncQueue;   ///< Queue of the writer thread (nullptr if synchronous)
+    static Ticker*                              mpTicker;       ///< Thread ticking the Output objects (or nullptr)
+    static std::atomic<Log::Level>              mDefaultLevel;  ///< Default Log::Level of any new Channel
+    static std::vector<const CallSite*>         mCallSites;     ///< CallSite registered since startup, by id - 1
+    static std::vector<std::string>             mCallSiteChannels;  ///< Channel having executed each CallSite first
+    static std::vector<CallSiteQuery>           mCallSiteQueries;   ///< Queries of setCallSites(), in order
+    static std::mutex                           mCallSitesMutex;    ///< Mutex protecting the registered CallSite
+    static char mThreadNames[MAX_THREAD_NAMES][Log::THREAD_NAME_SIZE];  ///< Padded names of the threads, never freed
+    static size_t                               mNbThreadNames;     ///< Number of names in the table
+    static std::mutex                           mThreadNamesMutex;  ///< Mutex protecting the names of the threads
 };
 
 
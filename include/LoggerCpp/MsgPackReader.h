@@ -0,0 +1,112 @@
+/**
+ * @file    MsgPackReader.h
+ * @ingroup LoggerCpp
+ * @brief   Streaming reader of the files written by the OutputMsgPack
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <LoggerCpp/Log.h>
+#include <LoggerCpp/Fields.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+
+namespace Log {
+
+
+/**
+ * @brief   Streaming reader of the files written by the OutputMsgPack
+ * @ingroup LoggerCpp
+ *
+ *  Reads the records one at a time, through a buffer reused from one record to the next:
+ * the strings of a Record point into this buffer, and are only valid until the following call to next().
+ * This lets an analytics job scan gigabytes of logs with a constant memory footprint and without text parsing.
+ *
+ * @code
+ * Log::MsgPackReader           reader("log.msgpack");
+ * Log::MsgPackReader::Record   record;
+ * while (reader.next(record)) {
+ *     if (Log::Log::eError <= record.level) { ... }
+ * }
+ * @endcode
+ */
+class MsgPackReader {
+public:
+    /// @brief A Log record read from the file (its strings are not null-terminated)
+    struct Record {
+        long long                   time;           ///< Nanoseconds since the Epoch (UTC)
+        Log::Level                  level;          ///< Severity Level
+        const char*                 pChannel;       ///< Name of the Channel
+        size_t                      channelSize;    ///< Size of the name of the Channel
+        const char*                 pMessage;       ///< Text of the message (without its fields)
+        size_t                      messageSize;    ///< Size of the text of the message
+        /**
+         * @brief Key/value fields, in their order in the Log
+         *
+         * Non-negative integers are decoded as Fields::eInt (or Fields::eUint above the range of a long long),
+         * whatever their type when they were logged.
+         */
+        std::vector<Fields::Field>  fields;
+    };
+
+    /**
+     * @brief Constructor : open the file
+     *
+     * @param[in] apFilename    Name of a file written by the OutputMsgPack
+     *
+     * @throw Exception if the file can not be opened
+     */
+    explicit MsgPackReader(const char* apFilename);
+
+    /// @brief Non virtual destructor : close the file
+    ~MsgPackReader(void);
+
+    /**
+     * @brief Read the next record
+     *
+     * @param[out] aRecord  Record read, valid until the next call
+     *
+     * @return false at the end of the file
+     *
+     * @throw Exception if the file is truncated or corrupted
+     */
+    bool next(Record& aRecord);
+
+    /// @brief Offset in the file of the end of the last record read
+    inline unsigned long long getOffset(void) const {
+        return mOffset;
+    }
+
+private:
+    /// @brief Read a byte of the current record
+    unsigned char readByte(void);
+    /// @brief Read a big-endian unsigned integer of the current record
+    unsigned long long readBigEndian(size_t aSize);
+    /// @brief Read a str of the current record
+    void readString(const char*& apString, size_t& aSize);
+    /// @brief Read any value of the current record into a field
+    void readValue(Fields::Field& aField);
+
+    /// @{ Non-copyable object
+    MsgPackReader(const MsgPackReader&);
+    void operator=(const MsgPackReader&);
+    /// @}
+
+private:
+    FILE*               mpFile;     ///< The file
+    std::string         mFilename;  ///< Name of the file, for error messages
+    std::vector<char>   mBuffer;    ///< The current record, reused from one record to the next
+    const char*         mpData;     ///< Current position in the current record
+    const char*         mpEnd;      ///< End of the current record
+    unsigned long long  mOffset;    ///< Offset in the file of the end of the current record
+};
+
+
+} // namespace Log
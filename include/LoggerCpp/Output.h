@@ -51,6 +51,31 @@ public:
      */
     virtual void output(const Channel::Ptr& aChannelPtr, const Log& aLog) const = 0;
 
+    /**
+     * @brief Write any buffered Log, called by Manager::flush() and Manager::terminate()
+     *
+     * Default implementation does nothing, for Output objects that do not buffer.
+     */
+    virtual void flush(void) const {}
+
+    /**
+     * @brief Apply the time based conditions of the Output, called periodically by the Manager (see Manager::TICK_PERIOD)
+     *
+     * Called from a background thread, concurrently with output(), so that buffered Log
+     * are written on time even when no other Log is output.
+     * Default implementation does nothing, for Output objects without any time based condition.
+     */
+    virtual void tick(void) const {}
+
+    /**
+     * @brief Number of Log lost because of a failure to write them, see Manager::getFailedCount()
+     *
+     * Default implementation returns 0, for Output objects that do not detect such failures.
+     */
+    virtual unsigned long getFailedCount(void) const {
+        return 0;
+    }
+
     /// @brief Return the type name of the Output object
     inline const char* name() const {
         return typeid(this).name();
@@ -0,0 +1,122 @@
+/**
+ * @file    OutputBinary.h
+ * @ingroup LoggerCpp
+ * @brief   Output to a compact binary file, decoded offline by the loggercpp-decode tool
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <LoggerCpp/OutputFile.h>
+#include <LoggerCpp/Config.h>
+
+#include <string>
+#include <unordered_map>
+
+
+namespace Log {
+
+
+/**
+ * @brief   Output to a compact binary file, decoded offline by the loggercpp-decode tool
+ * @ingroup LoggerCpp
+ *
+ *  No text is formatted on the hot path: the date, the Channel name and the Level of each Log
+ * are stored as a few binary bytes instead of a 40 characters header,
+ * and "loggercpp-decode" turns the file back into the same text as the OutputFile.
+ * The format string of a LOGF_xxx() macro is stored once per file with its CallSite,
+ * and each of its Log only stores its encoded arguments, formatted by "loggercpp-decode"
+ * (an argument of a type other than a number, a bool, a character or a string is stored as the text of its operator<<);
+ * the message of any other Log is stored as text.
+ *
+ *  The buffering, the flush policy and the rotation are those of the OutputFile,
+ * with the same options ("filename" defaults to "log.bin", and "filename_old" to "log.old.bin").
+ *
+ *  The file is a sequence of records, each one starting with a tag byte.
+ * Integers are unsigned LEB128 varints; signed ones are zigzag encoded first.
+ * - eRecordHeader  : "LCPPBIN", version byte, flags byte (eFlagUtc).
+ *                    Starts each file, and resets the Channel ids and the time base
+ *                    (a file appended to at startup contains more than one header).
+ * - eRecordChannel : Channel id, name length, name ; defines the id of a Channel before its first Log.
+ * - eRecordCallSite : CallSite id, line, file length, file, function length, function ;
+ *                    defines the id of the CallSite of a LOG_xxx() macro before its first Log.
+ * - eRecordFormat  : CallSite id, format length, format ; follows the definition of the CallSite of a LOGF_xxx() macro.
+ * - eRecordLog + Log::Level : Channel id, signed difference in nanoseconds with the time of the previous Log
+ *                    (with the Epoch for the first Log of a file), message length, message.
+ * - eRecordLogAt + Log::Level : Channel id, CallSite id, then as eRecordLog ; a Log produced by a LOG_xxx() macro.
+ * - eRecordLogArgs + Log::Level : Channel id, CallSite id, signed time difference, arguments length,
+ *                    arguments encoded as Fields without key (see Fields::appendArgs()) ;
+ *                    a Log produced by a LOGF_xxx() macro, its message being the format string of its CallSite.
+ */
+class OutputBinary : public OutputFile {
+public:
+    /// @brief Tag byte starting each record
+    enum Record {
+        eRecordLog      = 0x00, ///< Log record, added to its Log::Level
+        eRecordLogAt    = 0x10, ///< Log record with a CallSite, added to its Log::Level
+        eRecordLogArgs  = 0x20, ///< Log record with a CallSite and the arguments of its format, added to its Log::Level
+        eRecordHeader   = 'L',  ///< File header, followed by the rest of MAGIC
+        eRecordChannel  = 0x80, ///< Channel definition record
+        eRecordCallSite = 0x81, ///< CallSite definition record
+        eRecordFormat   = 0x82  ///< Format string definition record of a CallSite
+    };
+
+    /// @brief Flags of the file header
+    enum Flag {
+        eFlagUtc        = 0x01  ///< Dates are decoded in UTC instead of the local time zone
+    };
+
+    /// @brief Magic string and version byte starting each file header (including its tag byte)
+    static const char MAGIC[8];
+
+    /**
+     * @brief Constructor : open the output file, and ask for the arguments of the format strings
+     *
+     * @param[in] aConfigPtr    Config the output file with "filename"
+     */
+    explicit OutputBinary(const Config::Ptr& aConfigPtr);
+
+    /// @brief Destructor : stop asking for the arguments of the format strings
+    virtual ~OutputBinary();
+
+protected:
+    /**
+     * @brief Append the header of a new binary file to the buffer, and reset the Channel and CallSite ids and the time base
+     *
+     * @param[in,out] aBuffer   Buffer of the file
+     */
+    virtual void begin(std::string& aBuffer) const;
+
+    /**
+     * @brief Append the Log to the buffer, as a binary record (preceded by the definitions of its Channel and CallSite)
+     *
+     *  A Log of a LOGF_xxx() macro is stored as its arguments if it has any (and no key/value fields).
+     *
+     * @param[in,out] aBuffer       Buffer of the file
+     * @param[in]     aChannelPtr   The underlying Channel of the Log
+     * @param[in]     aLog          The Log to output
+     */
+    virtual void format(std::string& aBuffer, const Channel::Ptr& aChannelPtr, const Log& aLog) const;
+
+private:
+    /// @{ Non-copyable object
+    OutputBinary(const OutputBinary&);
+    void operator=(const OutputBinary&);
+    /// @}
+
+private:
+    /// @brief Map of Channel ids of the current file
+    typedef std::unordered_map<const Channel*, unsigned long> ChannelIdMap;
+    /// @brief Map of CallSite ids of the current file
+    typedef std::unordered_map<const CallSite*, unsigned long> CallSiteIdMap;
+
+    mutable ChannelIdMap    mChannelIds;    ///< @brief Ids of the Channel defined in the current file (mutable)
+    mutable CallSiteIdMap   mCallSiteIds;   ///< @brief Ids of the CallSite defined in the current file (mutable)
+    mutable long long       mLastTime;      ///< @brief Time of the previous Log in nanoseconds since the Epoch (mutable)
+};
+
+
+} // namespace Log
@@ -1,7 +1,7 @@
 /**
  * @file    OutputConsole.h
  * @ingroup LoggerCpp
- * @brief   Output to the standard console using fprintf() with stdout
+ * @brief   Output to the standard console (stdout)
  *
  * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
  *
@@ -12,18 +12,19 @@
 
 #include <LoggerCpp/Output.h>
 #include <LoggerCpp/Config.h>
+#include <LoggerCpp/Pattern.h>
 
 
 namespace Log {
 
 
 /**
- * @brief   Output to the standard console using fprintf() with stdout
+ * @brief   Output to the standard console (stdout)
  * @ingroup LoggerCpp
  */
 class OutputConsole : public Output {
 public:
-    /// @brief Constructor : no config
+    /// @brief Constructor : config the "pattern" of the Log lines
     explicit OutputConsole(const Config::Ptr& aConfigPtr);
 
     /// @brief Destructor
@@ -50,12 +51,20 @@ public:
 #endif // _WIN32
 
     /**
-     * @brief Output the Log to the standard console using fprintf
+     * @brief Output the Log to the standard console, with colors
      *
      * @param[in] aChannelPtr   The underlying Channel of the Log
      * @param[in] aLog          The Log to output
      */
     virtual void output(const Channel::Ptr& aChannelPtr, const Log& aLog) const;
+
+private:
+    /**
+     * @brief "pattern" : Layout of the Log lines, see Pattern
+     *
+     * Default (Pattern::DEFAULT) "YYYY-MM-DD HH:MM:SS.mmm  Channel      LEVL message".
+     */
+    Pattern     mPattern;
 };
 
 
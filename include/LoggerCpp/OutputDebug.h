@@ -12,6 +12,7 @@
 
 #include <LoggerCpp/Output.h>
 #include <LoggerCpp/Config.h>
+#include <LoggerCpp/Pattern.h>
 
 
 namespace Log {
@@ -23,7 +24,7 @@ namespace Log {
  */
 class OutputDebug : public Output {
 public:
-    /// @brief Constructor : no config
+    /// @brief Constructor : config the "pattern" of the Log lines
     explicit OutputDebug(const Config::Ptr& aConfigPtr);
 
     /// @brief Destructor
@@ -36,6 +37,14 @@ public:
      * @param[in] aLog          The Log to output
      */
     virtual void output(const Channel::Ptr& aChannelPtr, const Log& aLog) const;
+
+private:
+    /**
+     * @brief "pattern" : Layout of the Log lines, see Pattern
+     *
+     * Default (Pattern::DEFAULT) "YYYY-MM-DD HH:MM:SS.mmm  Channel      LEVL message".
+     */
+    Pattern     mPattern;
 };
 
 
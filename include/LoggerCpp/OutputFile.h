@@ -1,7 +1,7 @@
 /**
  * @file    OutputFile.h
  * @ingroup LoggerCpp
- * @brief   Output to the a file using fprintf
+ * @brief   Output to the a file using fwrite
  *
  * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
  *
@@ -12,7 +12,11 @@
 
 #include <LoggerCpp/Output.h>
 #include <LoggerCpp/Config.h>
+#include <LoggerCpp/Pattern.h>
 
+#include <chrono>
+#include <cstdio>
+#include <mutex>
 #include <string>
 
 
@@ -20,8 +24,12 @@ namespace Log {
 
 
 /**
- * @brief   Output to the standard console using fprintf
+ * @brief   Output to the a file using fwrite
  * @ingroup LoggerCpp
+ *
+ *  Log lines are accumulated in a user-space buffer, written to the (unbuffered) file
+ * with a single fwrite() call when one of the "flush_size", "flush_period" or "flush_level" condition is met.
+ * By default, each Log line is written immediately.
  */
 class OutputFile : public Output {
 public:
@@ -32,17 +40,51 @@ public:
      */
     explicit OutputFile(const Config::Ptr& aConfigPtr);
 
-    /// @brief Destructor : close the file
+    /**
+     * @brief Constructor : open the output file, with specific default file names
+     *
+     * @param[in] aConfigPtr            Config the output file with "filename"
+     * @param[in] apDefaultFilename     Default value of "filename"
+     * @param[in] apDefaultFilenameOld  Default value of "filename_old"
+     */
+    OutputFile(const Config::Ptr& aConfigPtr, const char* apDefaultFilename, const char* apDefaultFilenameOld);
+
+    /// @brief Destructor : write the buffer, synchronize and close the file
     virtual ~OutputFile();
 
     /**
-     * @brief Output the Log to the standard console using fprintf
+     * @brief Output the Log to the file buffer, and write the buffer if needed
      *
      * @param[in] aChannelPtr   The underlying Channel of the Log
      * @param[in] aLog          The Log to output
      */
     virtual void output(const Channel::Ptr& aChannelPtr, const Log& aLog) const;
 
+    /// @brief Write the buffer to the file
+    virtual void flush(void) const;
+
+    /// @brief Write the buffer to the file if "flush_period" has elapsed since the last write
+    virtual void tick(void) const;
+
+protected:
+    /**
+     * @brief Append the beginning of a new log file to the buffer (called with the mutex locked)
+     *
+     *  Called before the first Log output into each new (or rotated) file. Does nothing for a text file.
+     *
+     * @param[in,out] aBuffer   Buffer of the file
+     */
+    virtual void begin(std::string& aBuffer) const;
+
+    /**
+     * @brief Append the Log to the buffer, as a line of text (called with the mutex locked)
+     *
+     * @param[in,out] aBuffer       Buffer of the file
+     * @param[in]     aChannelPtr   The underlying Channel of the Log
+     * @param[in]     aLog          The Log to output
+     */
+    virtual void format(std::string& aBuffer, const Channel::Ptr& aChannelPtr, const Log& aLog) const;
+
 private:
     /// @brief Open the log file
     void open() const;
@@ -50,10 +92,16 @@ private:
     void close() const;
     /// @brief Rotate the log file : close, remove, rename, open
     void rotate() const;
+    /// @brief Write the buffer to the file (with the mutex locked)
+    void write() const;
 
 private:
-    mutable FILE*   mpFile; ///< @brief File pointer (mutable to be modified in the const output method)
-    mutable long    mSize;  ///< @brief Current size of the log file (mutable to be modified in the const output method)
+    mutable FILE*       mpFile;     ///< @brief File pointer (mutable to be modified in the const output method)
+    mutable long        mSize;      ///< @brief Current size of the log file, including the buffer (mutable)
+    mutable std::string mBuffer;    ///< @brief Log lines not yet written to the file (mutable)
+    mutable bool        mbBegin;    ///< @brief true until the first Log is output in the current file (mutable)
+    mutable std::mutex  mMutex;     ///< @brief Mutex protecting the buffer and the file (mutable)
+    mutable std::chrono::steady_clock::time_point mLastWrite;   ///< @brief Time of the last write (mutable)
 
     /** 
      * @brief "max_startup_size" : Size of the file above which to create a new file instead of appending to it (at startup).
@@ -78,6 +126,35 @@ private:
      * @brief "filename_old" : Name of the log file renamed after max_size is reach
      */
     std::string mFilenameOld;
+
+    /**
+     * @brief "flush_size" : Size of the buffer above which to write it to the file
+     *
+     * Default (0) writes each Log line immediately.
+     */
+    long        mFlushSize;
+
+    /**
+     * @brief "flush_period" : Time in milliseconds after which to write the buffer to the file
+     *
+     * Default (0) disables this condition. Checked when a Log is output, and by the periodic tick of the Manager,
+     * so a buffered Log is written at most "flush_period" + Manager::TICK_PERIOD after it was output.
+     */
+    long        mFlushPeriod;
+
+    /**
+     * @brief "flush_level" : Log::Level of severity from which to write the buffer immediately
+     *
+     * Default ("CRIT") writes the buffer immediately on each Critic Log.
+     */
+    Log::Level  mFlushLevel;
+
+    /**
+     * @brief "pattern" : Layout of the Log lines, see Pattern
+     *
+     * Default (Pattern::DEFAULT) "YYYY-MM-DD HH:MM:SS.mmm  Channel      LEVL message".
+     */
+    Pattern     mPattern;
 };
 
 
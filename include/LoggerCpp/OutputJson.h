@@ -0,0 +1,85 @@
+/**
+ * @file    OutputJson.h
+ * @ingroup LoggerCpp
+ * @brief   Output to a JSON Lines file, one JSON object per Log with its typed key/value fields
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <LoggerCpp/OutputFile.h>
+#include <LoggerCpp/Config.h>
+
+#include <string>
+
+
+namespace Log {
+
+
+/**
+ * @brief   Output to a JSON Lines file, one JSON object per Log with its typed key/value fields
+ * @ingroup LoggerCpp
+ *
+ *  Each Log is written on its own line as:
+ * {"time":"2013-07-14T21:42:04.123456","channel":"Main.Example","level":"INFO","message":"login","user":42}
+ * followed by its key/value fields (see kv()) as JSON booleans, numbers and strings.
+ * The time ends with a 'Z' when DateTime::setUtc(true) is used.
+ *
+ *  Strings are escaped 16 bytes at a time with SSE2 (or 32 bytes with AVX2 when compiled with -mavx2),
+ * only falling back to a byte-by-byte copy around the characters to escape.
+ *
+ *  The buffering, the flush policy and the rotation are those of the OutputFile,
+ * with the same options ("filename" defaults to "log.json", and "filename_old" to "log.old.json").
+ */
+class OutputJson : public OutputFile {
+public:
+    /**
+     * @brief Constructor : open the output file
+     *
+     * @param[in] aConfigPtr    Config the output file with "filename"
+     */
+    explicit OutputJson(const Config::Ptr& aConfigPtr);
+
+    /// @brief Destructor
+    virtual ~OutputJson();
+
+    /**
+     * @brief Append a string to a buffer, escaped for JSON (without the surrounding quotes)
+     *
+     * @param[in,out] aBuffer   Destination buffer
+     * @param[in]     apData    Characters of the string (UTF-8)
+     * @param[in]     aSize     Size of the string
+     */
+    static void escape(std::string& aBuffer, const char* apData, size_t aSize);
+
+    /**
+     * @brief Append the key/value fields of a Log to a buffer, as ',"key":value' JSON members
+     *
+     * @param[in,out] aBuffer   Destination buffer
+     * @param[in]     apFields  Encoded fields of the Log (see Log::getFields())
+     * @param[in]     aSize     Size of the encoded fields
+     */
+    static void appendFields(std::string& aBuffer, const char* apFields, size_t aSize);
+
+protected:
+    /**
+     * @brief Append the Log to the buffer, as a line of JSON
+     *
+     * @param[in,out] aBuffer       Buffer of the file
+     * @param[in]     aChannelPtr   The underlying Channel of the Log
+     * @param[in]     aLog          The Log to output
+     */
+    virtual void format(std::string& aBuffer, const Channel::Ptr& aChannelPtr, const Log& aLog) const;
+
+private:
+    /// @{ Non-copyable object
+    OutputJson(const OutputJson&);
+    void operator=(const OutputJson&);
+    /// @}
+};
+
+
+} // namespace Log
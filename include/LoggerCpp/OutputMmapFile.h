@@ -0,0 +1,156 @@
+/**
+ * @file    OutputMmapFile.h
+ * @ingroup LoggerCpp
+ * @brief   Output to a memory-mapped, preallocated file, without any write system call
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#ifdef __unix__
+
+#include <LoggerCpp/Output.h>
+#include <LoggerCpp/Config.h>
+#include <LoggerCpp/Pattern.h>
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <string>
+
+
+namespace Log {
+
+
+/**
+ * @brief   Output to a memory-mapped, preallocated file, without any write system call
+ * @ingroup LoggerCpp
+ *
+ *  The log file is a segment of "max_size" bytes, preallocated with posix_fallocate() and mapped in memory.
+ * Each Log line reserves its room with an atomic fetch-and-add on the used size of the segment,
+ * and is then copied straight into the mapping: the steady state does not do any system call,
+ * and concurrent threads do not wait for each other.
+ *
+ *  The rotation follows the same semantic as the OutputFile, with "filename", "filename_old",
+ * "max_size" and "max_startup_size" : when a segment is full, the next one (pre-created as "filename.next")
+ * takes its place, and the full one is renamed to "filename_old" and truncated to its used size.
+ *
+ * @note Until it is closed, the current log file has a size of "max_size" and ends with null bytes.
+ * After a crash, the file is truncated at startup after its last non-null byte, and new Log are appended there.
+ */
+class OutputMmapFile : public Output {
+public:
+    /**
+     * @brief Constructor : create and map the first segments of the output file
+     *
+     * @param[in] aConfigPtr    Config the output file with "filename", "filename_old" and "max_size"
+     */
+    explicit OutputMmapFile(const Config::Ptr& aConfigPtr);
+
+    /// @brief Destructor : synchronize, truncate and close the file, remove the next segment
+    virtual ~OutputMmapFile();
+
+    /**
+     * @brief Output the Log by copying it in the memory-mapped file
+     *
+     * @param[in] aChannelPtr   The underlying Channel of the Log
+     * @param[in] aLog          The Log to output
+     */
+    virtual void output(const Channel::Ptr& aChannelPtr, const Log& aLog) const;
+
+    /// @brief Synchronize the used part of the current segment with the file (msync)
+    virtual void flush(void) const;
+
+private:
+    /// @brief A memory-mapped, preallocated file
+    struct Segment {
+        int                 mFd;        ///< File descriptor (-1 when not opened)
+        char*               mpData;     ///< Mapping of the file (nullptr when not mapped)
+        std::atomic<size_t> mUsed;      ///< Number of bytes reserved in the segment (can go above its size)
+        std::atomic<int>    mUsers;     ///< Number of threads currently writing into the segment
+    };
+
+    /**
+     * @brief Create (or reopen) a segment file, preallocate and map it
+     *
+     * @param[in,out]   aSegment    Segment to open
+     * @param[in]       aFilename   Name of the file of the segment
+     * @param[in]       aUsed       Number of bytes already used in the file
+     */
+    void open(Segment& aSegment, const std::string& aFilename, size_t aUsed) const;
+
+    /**
+     * @brief Synchronize, unmap, truncate to its used size and close a segment
+     *
+     * @param[in,out]   aSegment    Segment to close
+     * @param[in]       aUsed       Number of bytes used in the segment
+     */
+    void close(Segment& aSegment, size_t aUsed) const;
+
+    /**
+     * @brief Rotate a full segment : swap in the next segment, close, remove, rename, and create a new next segment
+     *
+     * @param[in,out]   aSegment    The full segment
+     * @param[in]       aUsed       Number of bytes used in the full segment
+     */
+    void rotate(Segment& aSegment, size_t aUsed) const;
+
+    /// @brief The segment following the provided one
+    inline Segment& next(const Segment& aSegment) const {
+        return (&aSegment == &mSegments[0]) ? mSegments[1] : mSegments[0];
+    }
+
+    /// @{ Non-copyable object
+    OutputMmapFile(const OutputMmapFile&);
+    void operator=(const OutputMmapFile&);
+    /// @}
+
+private:
+    mutable Segment                 mSegments[2];   ///< @brief The current and the next segments (mutable)
+    mutable std::atomic<Segment*>   mpCurrent;      ///< @brief The current segment (mutable)
+    mutable std::mutex              mRotateMutex;   ///< @brief Mutex protecting the rotation (mutable)
+
+    /**
+     * @brief "max_startup_size" : Size of the file above which to create a new file instead of appending to it (at startup).
+     *
+     * Default (0) creates a new file at each startup (never append to an existing one).
+     */
+    long        mMaxStartupSize;
+
+    /**
+     * @brief "max_size" : Size of each segment, above which to rotate the file.
+     *
+     * Default (1024*1024=1Mo).
+     */
+    size_t      mMaxSize;
+
+    /**
+     * @brief "filename" : Name of the log file
+     */
+    std::string mFilename;
+
+    /**
+     * @brief "filename_old" : Name of the log file renamed after max_size is reach
+     */
+    std::string mFilenameOld;
+
+    /**
+     * @brief Name of the pre-created next segment ("filename" followed by ".next")
+     */
+    std::string mFilenameNext;
+
+    /**
+     * @brief "pattern" : Layout of the Log lines, see Pattern
+     *
+     * Default (Pattern::DEFAULT) "YYYY-MM-DD HH:MM:SS.mmm  Channel      LEVL message".
+     */
+    Pattern     mPattern;
+};
+
+
+} // namespace Log
+
+#endif // __unix__
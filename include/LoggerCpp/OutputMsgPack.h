@@ -0,0 +1,69 @@
+/**
+ * @file    OutputMsgPack.h
+ * @ingroup LoggerCpp
+ * @brief   Output to a file of length-prefixed MessagePack maps, read back by the MsgPackReader
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <LoggerCpp/OutputFile.h>
+#include <LoggerCpp/Config.h>
+
+#include <string>
+
+
+namespace Log {
+
+
+/**
+ * @brief   Output to a file of length-prefixed MessagePack maps, read back by the MsgPackReader
+ * @ingroup LoggerCpp
+ *
+ *  Each Log is written as a 4 bytes big-endian size, followed by a MessagePack map of this size:
+ * - "time"    : int64, nanoseconds since the Epoch (UTC)
+ * - "channel" : str, name of the Channel
+ * - "level"   : str, Log::toString() of the Level ("DBUG", "INFO"...)
+ * - "message" : str, text of the message (without its key/value fields)
+ * followed by the key/value fields of the Log (see kv()) as MessagePack bool, int, float64 or str.
+ *
+ *  The size prefix lets a reader skip or map whole records without decoding them.
+ * Records are encoded straight into the buffer of the OutputFile, without any allocation.
+ *
+ *  The buffering, the flush policy and the rotation are those of the OutputFile,
+ * with the same options ("filename" defaults to "log.msgpack", and "filename_old" to "log.old.msgpack").
+ */
+class OutputMsgPack : public OutputFile {
+public:
+    /**
+     * @brief Constructor : open the output file
+     *
+     * @param[in] aConfigPtr    Config the output file with "filename"
+     */
+    explicit OutputMsgPack(const Config::Ptr& aConfigPtr);
+
+    /// @brief Destructor
+    virtual ~OutputMsgPack();
+
+protected:
+    /**
+     * @brief Append the Log to the buffer, as a length-prefixed MessagePack map
+     *
+     * @param[in,out] aBuffer       Buffer of the file
+     * @param[in]     aChannelPtr   The underlying Channel of the Log
+     * @param[in]     aLog          The Log to output
+     */
+    virtual void format(std::string& aBuffer, const Channel::Ptr& aChannelPtr, const Log& aLog) const;
+
+private:
+    /// @{ Non-copyable object
+    OutputMsgPack(const OutputMsgPack&);
+    void operator=(const OutputMsgPack&);
+    /// @}
+};
+
+
+} // namespace Log
@@ -0,0 +1,143 @@
+/**
+ * @file    OutputSqlite.h
+ * @ingroup LoggerCpp
+ * @brief   Output to a SQLite database file (db3), with batched transactions
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <LoggerCpp/Output.h>
+#include <LoggerCpp/Config.h>
+#include <LoggerCpp/Log.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+
+// Forward declarations of the SQLite types, to keep the sqlite3.h header private to the library
+struct sqlite3;
+struct sqlite3_stmt;
+
+
+namespace Log {
+
+
+/**
+ * @brief   Output to a SQLite database file (db3), with batched transactions
+ * @ingroup LoggerCpp
+ *
+ *  Each Log is a row of the "log" table, inserted by a single prepared statement:
+ * - "time"    : INTEGER, nanoseconds since the Epoch (UTC)
+ * - "channel" : TEXT, name of the Channel
+ * - "level"   : INTEGER, Log::Level (0 for DBUG up to 5 for CRIT)
+ * - "message" : TEXT, text of the message (without its key/value fields)
+ * - "fields"  : TEXT, JSON object of the key/value fields (see kv()), or NULL
+ *
+ * with an index on each of "time", "channel" and "level", so that the logs can be queried directly:
+ * @code
+ * SELECT * FROM log WHERE level >= 3 AND time BETWEEN strftime('%s','now','-1 hour')*1000000000 AND ...
+ * @endcode
+ *
+ *  The database is in WAL mode, and the rows are grouped into transactions committed
+ * when one of the "batch_size", "batch_period" or "flush_level" condition is met,
+ * so the cost of a Log stays that of an insertion in memory, the disk being synchronized once per transaction.
+ * A Log is never allowed to throw from the logging path: the Log lost because an insertion fails,
+ * or because a transaction can not be committed and is rolled back, are counted by getFailedCount().
+ *
+ *  Only available when the library is built with SQLite (LOGGERCPP_WITH_SQLITE).
+ */
+class OutputSqlite : public Output {
+public:
+    /**
+     * @brief Constructor : open the database, create its table and indexes, and prepare the insertion
+     *
+     * @param[in] aConfigPtr    Config the output with "filename"
+     *
+     * @throw Exception if the database can not be opened or initialized
+     */
+    explicit OutputSqlite(const Config::Ptr& aConfigPtr);
+
+    /// @brief Destructor : commit the current transaction and close the database
+    virtual ~OutputSqlite();
+
+    /**
+     * @brief Insert the Log into the current transaction, and commit it if needed
+     *
+     * @param[in] aChannelPtr   The underlying Channel of the Log
+     * @param[in] aLog          The Log to output
+     */
+    virtual void output(const Channel::Ptr& aChannelPtr, const Log& aLog) const;
+
+    /// @brief Commit the current transaction
+    virtual void flush(void) const;
+
+    /// @brief Commit the current transaction if "batch_period" has elapsed since its beginning
+    virtual void tick(void) const;
+
+    /// @brief Number of Log lost because their insertion or their transaction failed
+    virtual unsigned long getFailedCount(void) const {
+        return mFailedCount.load(std::memory_order_relaxed);
+    }
+
+private:
+    /// @brief Close the database and throw the error of an SQL statement of the constructor
+    void fail(const char* apSql);
+    /// @brief Commit the current transaction, or roll it back if it can not be committed (with the mutex locked)
+    void commit() const;
+
+    /// @{ Non-copyable object
+    OutputSqlite(const OutputSqlite&);
+    void operator=(const OutputSqlite&);
+    /// @}
+
+private:
+    sqlite3*                mpDatabase;     ///< @brief The database connection
+    sqlite3_stmt*           mpInsert;       ///< @brief The prepared INSERT statement
+    mutable long            mBatchCount;    ///< @brief Number of Log in the current transaction (mutable)
+    mutable std::atomic<unsigned long> mFailedCount;    ///< @brief Number of Log lost by a failure (mutable)
+    mutable std::string     mFields;        ///< @brief JSON of the fields of the current Log, reused (mutable)
+    mutable std::mutex      mMutex;         ///< @brief Mutex protecting the connection (mutable)
+    mutable std::chrono::steady_clock::time_point mBatchStart;  ///< @brief Start of the transaction (mutable)
+
+    /**
+     * @brief "filename" : Name of the database file
+     */
+    std::string mFilename;
+
+    /**
+     * @brief "batch_size" : Number of Log after which to commit the transaction
+     *
+     * Default (1000). 1 commits each Log immediately.
+     */
+    long        mBatchSize;
+
+    /**
+     * @brief "batch_period" : Time in milliseconds after which to commit the transaction
+     *
+     * Default (1000). Checked when a Log is output, and by the periodic tick of the Manager,
+     * so that an idle logger does not keep its transaction open (and the WAL write lock) indefinitely.
+     */
+    long        mBatchPeriod;
+
+    /**
+     * @brief "busy_timeout" : Time in milliseconds to wait for the database locked by another connection
+     *
+     * Default (1000). A transaction that can not be committed after this time is rolled back, see getFailedCount().
+     */
+    long        mBusyTimeout;
+
+    /**
+     * @brief "flush_level" : Log::Level of severity from which to commit the transaction immediately
+     *
+     * Default ("CRIT") commits the transaction immediately on each Critic Log.
+     */
+    Log::Level  mFlushLevel;
+};
+
+
+} // namespace Log
@@ -15,6 +15,7 @@
 
 #include <LoggerCpp/Output.h>
 #include <LoggerCpp/Config.h>
+#include <LoggerCpp/Pattern.h>
 
 #include <string>
 
@@ -51,6 +52,13 @@ private:
      * @brief "name" : Name (prefix) of the entry in syslog.
      */
     std::string mLogname;
+
+    /**
+     * @brief "pattern" : Layout of the Log lines, see Pattern (syslog adds the date and time itself)
+     *
+     * Default (Pattern::DEFAULT_NO_TIME) "Channel      LEVL message".
+     */
+    Pattern     mPattern;
 };
 
 
@@ -0,0 +1,126 @@
+/**
+ * @file    Pattern.h
+ * @ingroup LoggerCpp
+ * @brief   A line layout, compiled once from a pattern string into a flat list of append operations
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <LoggerCpp/Log.h>
+
+#include <string>
+#include <vector>
+
+
+namespace Log {
+
+
+/**
+ * @brief   A line layout, compiled once from a pattern string into a flat list of append operations
+ * @ingroup LoggerCpp
+ *
+ *  The text outputs (OutputConsole, OutputFile, OutputMmapFile, OutputSyslog, OutputDebug) accept a "pattern" option
+ * made of literal text and of the following directives:
+ * - "%Y" year (4 digits), "%m" month, "%d" day, "%H" hour, "%M" minute, "%S" second (2 digits)
+ * - "%e" milliseconds (3 digits), "%f" microseconds (6 digits), "%N" nanoseconds (9 digits)
+ * - "%E" nanoseconds since the Epoch (UTC)
+ * - "%t" id of the thread of the Log
+ * - "%T" name of the thread of the Log (see Manager::setThreadName()), or else its id,
+ *   left-aligned on Log::THREAD_NAME_SIZE characters
+ * - "%s" source file name (without directories), "%g" source file as given by the compiler, "%#" line, "%!" function,
+ *   of the LOG_xxx() macro that produced the Log (empty for a Log without CallSite)
+ * - "%c" name of the Channel, "%l" Log::Level ("DBUG" ... "CRIT"), "%v" message (with its key/value fields)
+ * - "%%" a single '%'
+ *
+ * "%E", "%t", "%s", "%g", "%#", "%!", "%c", "%l" and "%v" take an optional minimum width, padded with spaces: "%12c" right-aligned, "%-12c" left-aligned.
+ *
+ *  The pattern is parsed once by the constructor, so that format() only runs a switch over its operations,
+ * writing the literal text and the fields of the Log directly into the buffer, grown once, without any printf.
+ * The default pattern DEFAULT (and its variant without the date DEFAULT_NO_TIME) is not even run:
+ * it is the text header rendered once by Log::getHeader() and shared by all the outputs.
+ */
+class Pattern {
+public:
+    /// @brief Default pattern, "YYYY-MM-DD HH:MM:SS.mmm  Channel      LEVL message"
+    static const char* const DEFAULT;
+    /// @brief Default pattern without the date and time, for outputs timestamping the Log themselves (syslog)
+    static const char* const DEFAULT_NO_TIME;
+
+    /**
+     * @brief Constructor : compile the pattern
+     *
+     * @param[in] apPattern Pattern string, see above
+     *
+     * @throw Exception on an unknown or incomplete directive
+     */
+    explicit Pattern(const char* apPattern);
+
+    /**
+     * @brief Append the Log formatted by the pattern to the buffer (without any end of line)
+     *
+     * @param[in,out] aBuffer       Buffer to append the Log to
+     * @param[in]     aChannelName  Name of the underlying Channel of the Log
+     * @param[in]     aLog          The Log to format
+     */
+    void format(std::string& aBuffer, const std::string& aChannelName, const Log& aLog) const;
+
+private:
+    /// @brief Type of an append operation
+    enum Type {
+        eLiteral = 0,   ///< Literal text of the pattern
+        eYear,          ///< %Y
+        eMonth,         ///< %m
+        eDay,           ///< %d
+        eHour,          ///< %H
+        eMinute,        ///< %M
+        eSecond,        ///< %S
+        eMilli,         ///< %e
+        eMicro,         ///< %f
+        eNano,          ///< %N
+        eEpochNano,     ///< %E
+        eThread,        ///< %t
+        eThreadName,    ///< %T
+        eFile,          ///< %s
+        eFullFile,      ///< %g
+        eLine,          ///< %#
+        eFunction,      ///< %!
+        eChannel,       ///< %c
+        eLevel,         ///< %l
+        eMessage        ///< %v
+    };
+
+    /// @brief An append operation : a directive, or a range of the literal text
+    struct Op {
+        Type    mType;      ///< Type of the operation
+        bool    mbLeft;     ///< Left-aligned, padded on the right (for a minimum width)
+        size_t  mWidth;     ///< Minimum width (0 for none), or size of the literal text
+        size_t  mOffset;    ///< Offset of the literal text in mLiterals
+    };
+
+    /**
+     * @brief Write a text padded to the minimum width of the operation
+     *
+     * @param[in] apOut     Where to write the text
+     * @param[in] aOp       The operation
+     * @param[in] apText    Text to write
+     * @param[in] aSize     Size of the text
+     *
+     * @return End of the written text
+     */
+    static char* write(char* apOut, const Op& aOp, const char* apText, size_t aSize);
+
+private:
+    std::vector<Op> mOps;           ///< The operations, in order
+    std::string     mLiterals;      ///< The literal text of all the eLiteral operations
+    size_t          mMaxSize;       ///< Maximum size of a formatted Log, without its Channel name and its message
+    size_t          mHeaderOffset;  ///< Offset in the shared header of Log::getHeader() (npos if not a default pattern)
+    bool            mbCalendar;     ///< true if the pattern prints calendar fields, converted by Log::getTime()
+    bool            mbCallSite;     ///< true if the pattern prints the file or the function of the CallSite
+};
+
+
+} // namespace Log
@@ -0,0 +1,88 @@
+/**
+ * @file    RateLimit.h
+ * @ingroup LoggerCpp
+ * @brief   Lock-free token bucket limiting the rate of a Log statement
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+
+namespace Log {
+
+
+/**
+ * @brief   Lock-free token bucket limiting the rate of a Log statement
+ * @ingroup LoggerCpp
+ *
+ *  Allows bursts of up to "burst" Log, refilled at "rate" Log per second.
+ * It is implemented as a Generic Cell Rate Algorithm: the whole bucket is a single atomic timestamp,
+ * the "theoretical arrival time" of the next Log, updated by a compare-and-swap.
+ * A suppressed Log costs a clock read, an atomic load and an atomic increment, before any formatting.
+ *
+ *  Used through the LOG_ERROR_LIMIT() ... macros, declaring one RateLimit per call site;
+ * the first Log output after some were suppressed carries a "suppressed" key/value field with their number.
+ */
+class RateLimit {
+public:
+    /**
+     * @brief Constructor (constexpr, so that a static RateLimit is initialized at compile time)
+     *
+     * @param[in] aRate     Number of Log per second allowed in the long run (> 0)
+     * @param[in] aBurst    Number of Log allowed at once (>= 1)
+     */
+    constexpr RateLimit(double aRate, unsigned int aBurst) :
+        mInterval(static_cast<long long>(1000000000.0 / aRate)),
+        mTolerance(static_cast<long long>(1000000000.0 / aRate) * aBurst),
+        mNext(0),
+        mSuppressed(0)
+    {}
+
+    /**
+     * @brief Take a token from the bucket
+     *
+     * @return -1 if the Log is to be suppressed,
+     *         or else the number of Log suppressed since the previous one allowed (usually 0)
+     */
+    inline long acquire(void) {
+        const long long now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now().time_since_epoch()).count();
+        long long next = mNext.load(std::memory_order_relaxed);
+        long long newNext;
+        do {
+            newNext = ((next > now) ? next : now) + mInterval;
+            if (newNext - now > mTolerance) {
+                mSuppressed.fetch_add(1, std::memory_order_relaxed);
+                return -1;
+            }
+        } while (!mNext.compare_exchange_weak(next, newNext, std::memory_order_relaxed));
+
+        // Only write the counter when there is something to report, to keep its cache line shared
+        long suppressed = mSuppressed.load(std::memory_order_relaxed);
+        if (0 != suppressed) {
+            suppressed = mSuppressed.exchange(0, std::memory_order_relaxed);
+        }
+        return suppressed;
+    }
+
+private:
+    /// @{ Non-copyable object
+    RateLimit(const RateLimit&);
+    void operator=(const RateLimit&);
+    /// @}
+
+private:
+    const long long         mInterval;      ///< Nanoseconds between two Log in the long run
+    const long long         mTolerance;     ///< Nanoseconds of advance allowed, for the bursts
+    std::atomic<long long>  mNext;          ///< Theoretical time of the next Log, on the steady clock
+    std::atomic<long>       mSuppressed;    ///< Number of Log suppressed since the last one allowed
+};
+
+
+} // namespace Log
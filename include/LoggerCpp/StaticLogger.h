@@ -0,0 +1,92 @@
+/**
+ * @file    StaticLogger.h
+ * @ingroup LoggerCpp
+ * @brief   A Logger declared as a constant, looking its Channel up only once
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <LoggerCpp/Logger.h>
+
+#include <atomic>
+
+
+namespace Log {
+
+
+/**
+ * @brief   A Logger declared as a constant, looking its Channel up only once
+ * @ingroup LoggerCpp
+ *
+ *  A StaticLogger is built by the compiler (constexpr), without any code run at startup,
+ * so it can be declared at namespace scope without any static initialization order issue, see LOGGER_DECLARE().
+ * Its Channel is looked up in the table of the Manager on its first use only:
+ * then each Logger got from it is a copy of two pointers, without any lookup nor atomic read-modify-write.
+ *
+ * @code
+ * LOGGER_DECLARE(sTesterLogger, "Main.Tester");
+ *
+ * class Tester {
+ * public:
+ *     Tester() : mLogger(sTesterLogger.get()) {}
+ * private:
+ *     Log::Logger mLogger;
+ * };
+ * @endcode
+ */
+class StaticLogger {
+public:
+    /**
+     * @brief Constructor (constexpr, so that a static StaticLogger is initialized at compile time)
+     *
+     * @param[in] apChannelName String to identify the underlying Channel (a string literal)
+     */
+    constexpr explicit StaticLogger(const char* apChannelName) :
+        mpChannelName(apChannelName),
+        mpChannelPtr(nullptr)
+    {}
+
+    /// @brief The Logger of the Channel, looked up on the first call only
+    inline Logger get(void) const {
+        const Channel::Ptr* pChannelPtr = mpChannelPtr.load(std::memory_order_acquire);
+        if (nullptr == pChannelPtr) {
+            pChannelPtr = lookup();
+        }
+        return Logger(*pChannelPtr);
+    }
+
+    /// @brief Name of the underlying Channel
+    inline const char* getName(void) const {
+        return mpChannelName;
+    }
+
+private:
+    /// @{ Non-copyable object
+    StaticLogger(const StaticLogger&);
+    void operator=(const StaticLogger&);
+    /// @}
+
+    /// @brief Look the Channel up in the table of the Manager, and keep its pointer
+    const Channel::Ptr* lookup(void) const;
+
+private:
+    const char* const                           mpChannelName;  ///< Name of the underlying Channel
+    mutable std::atomic<const Channel::Ptr*>    mpChannelPtr;   ///< Channel in the table of the Manager, or nullptr
+};
+
+
+} // namespace Log
+
+
+/**
+ * @brief Declare a StaticLogger constant, built at compile time and looking its Channel up on its first use only
+ *
+ * @param[in] logger    Name of the StaticLogger variable
+ * @param[in] name      Name of the underlying Channel (a string literal)
+ */
+#define LOGGER_DECLARE(logger, name) \
+    static constexpr ::Log::StaticLogger logger(name)
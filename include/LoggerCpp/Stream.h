@@ -0,0 +1,229 @@
+/**
+ * @file    Stream.h
+ * @ingroup LoggerCpp
+ * @brief   A reusable output string stream, recycled by each thread to format Log objects without allocation
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <ostream>  // NOLINT(readability/streams) the whole point of a Stream
+#include <streambuf>
+#include <string>
+#include <vector>
+
+
+namespace Log {
+
+
+/**
+ * @brief   A reusable output string stream, recycled by each thread to format Log objects without allocation
+ * @ingroup LoggerCpp
+ *
+ *  A Stream is a std::ostream writing into a growing character buffer,
+ * like a std::ostringstream, but which gives a zero-copy access to its content,
+ * and which is meant to be reused instead of being destroyed.
+ *
+ *  Each thread keeps a small pool of Stream objects: acquire() takes one from the pool of the current thread,
+ * and release() gives it back. Since a Stream keeps its buffer and its locale,
+ * a Log formatted in steady state does not allocate any memory.
+ */
+class Stream : public std::ostream {
+public:
+    /// @brief Constructor : empty stream
+    Stream(void);
+
+    /// @brief Virtual destructor
+    virtual ~Stream(void);
+
+    /**
+     * @brief Take a Stream from the pool of the current thread (or create a new one if it is empty)
+     *
+     * @return An empty Stream in its default formatting state
+     */
+    static Stream* acquire(void);
+
+    /**
+     * @brief Give back a Stream to the pool of the current thread
+     *
+     * @param[in] apStream  Stream obtained with acquire()
+     */
+    static void release(Stream* apStream);
+
+    /// @brief Clear the content, the fields and the arguments, and reset the formatting state (flags, width...)
+    void reset(void);
+
+    /// @brief Null-terminated content of the stream (zero-copy, valid until the next write)
+    inline const char* c_str(void) const {
+        return mBuffer.c_str();
+    }
+
+    /// @brief Size of the content of the stream
+    inline size_t size(void) const {
+        return mBuffer.size();
+    }
+
+    /// @brief Append characters directly to the content, bypassing the formatting of the std::ostream
+    inline void append(const char* apData, size_t aSize) {
+        mBuffer.sputn(apData, static_cast<std::streamsize>(aSize));
+    }
+
+    /// @brief Append a character repeated the given number of times, bypassing the formatting of the std::ostream
+    void append(size_t aCount, char aChar);
+
+    /// @brief Shorten the content to the given size, keeping the allocated memory
+    inline void truncate(size_t aSize) {
+        mBuffer.truncate(aSize);
+    }
+
+    /**
+     * @brief Append a value with its operator<<, in the default formatting state, keeping the current state
+     *
+     * @param[in] aValue    Value to append
+     */
+    template <typename T>
+    void appendDefault(const T& aValue) {
+        const std::ios::fmtflags    flags       = this->flags(mFlags);
+        const std::streamsize       width       = this->width(0);
+        const std::streamsize       precision   = this->precision(6);
+        const char                  fill        = this->fill(' ');
+        *this << aValue;
+        this->flags(flags);
+        this->width(width);
+        this->precision(precision);
+        this->fill(fill);
+    }
+
+    /**
+     * @brief true if the stream is in its default formatting state (no flag set by a manipulator, and no width)
+     *
+     * Only then are the appendInteger(), appendDouble() and appendPointer() conversions
+     * identical to the formatting of the std::ostream.
+     */
+    inline bool isDefault(void) const {
+        return (flags() == mFlags) && (0 == width());
+    }
+
+    /**
+     * @brief Append an integer in decimal, converted by hand, bypassing the std::ostream (see isDefault())
+     *
+     * @param[in] aValue        Absolute value
+     * @param[in] abNegative    Sign of the value
+     */
+    void appendInteger(unsigned long long aValue, bool abNegative);
+
+    /// @brief Append a floating point value with the precision of the stream, bypassing the std::ostream
+    void appendDouble(double aValue);
+
+    /// @brief Size of a buffer big enough for the conversions of toGeneral() and toFixed()
+    static const size_t DOUBLE_CHARS = 64;
+
+    /**
+     * @brief Convert a floating point value as "%.*g" does, without snprintf() for an integral value
+     *        or a value with a few decimals
+     *
+     * @param[out] apBuffer     Buffer of DOUBLE_CHARS
+     * @param[in]  aValue       Value to convert
+     * @param[in]  aPrecision   Maximum number of significant digits
+     *
+     * @return Number of characters written (not null-terminated), or 0 if they do not fit in the buffer
+     */
+    static size_t toGeneral(char* apBuffer, double aValue, int aPrecision);
+
+    /**
+     * @brief Convert a floating point value as "%.*f" does, without snprintf() for a precision below 10
+     *        and a value below 2^40 once scaled by it
+     *
+     * @param[out] apBuffer     Buffer of DOUBLE_CHARS
+     * @param[in]  aValue       Value to convert
+     * @param[in]  aPrecision   Number of decimals
+     *
+     * @return Number of characters written (not null-terminated), or 0 if they do not fit in the buffer
+     */
+    static size_t toFixed(char* apBuffer, double aValue, int aPrecision);
+
+    /// @brief Append a pointer in hexadecimal ("0x1a2b", or "0" for nullptr), bypassing the std::ostream
+    void appendPointer(const void* apValue);
+
+    /**
+     * @brief Convert an unsigned integer to decimal, two digits at a time, at the end of a buffer
+     *
+     * @param[in] aValue    Value to convert
+     * @param[in] apEnd     End of the buffer (of at least 20 characters)
+     *
+     * @return Beginning of the converted digits
+     */
+    static char* toDecimal(unsigned long long aValue, char* apEnd);
+
+    /// @brief Buffer of the key/value fields of the Log, encoded by the Fields class (recycled with the Stream)
+    inline std::string& fields(void) {
+        return mFields;
+    }
+
+    /// @brief Buffer of the arguments of the format string of the Log, encoded by Fields::appendArgs() (recycled)
+    inline std::string& args(void) {
+        return mArgs;
+    }
+
+private:
+    /**
+     * @brief The stream buffer of a Stream, writing into a growing vector of characters
+     *
+     * It always reserves one extra character at the end of the vector for the null terminator.
+     */
+    class Buffer : public std::streambuf {
+    public:
+        /// @brief Constructor : allocate a first buffer
+        Buffer(void);
+
+        /// @brief Clear the content, keeping the allocated memory
+        void clear(void);
+
+        /// @brief Shorten the content to the given size, keeping the allocated memory
+        inline void truncate(size_t aSize) {
+            pbump(static_cast<int>(aSize) - static_cast<int>(size()));
+        }
+
+        /// @brief Null-terminated content of the buffer
+        inline const char* c_str(void) const {
+            *pptr() = '\0';
+            return pbase();
+        }
+
+        /// @brief Size of the content of the buffer
+        inline size_t size(void) const {
+            return static_cast<size_t>(pptr() - pbase());
+        }
+
+    protected:
+        /// @brief Grow the buffer to make room for one more character
+        virtual int_type overflow(int_type aChar);
+
+        /// @brief Write a sequence of characters, growing the buffer at once if needed
+        virtual std::streamsize xsputn(const char_type* apData, std::streamsize aSize);
+
+    private:
+        /// @brief Grow the buffer so that it can hold at least the requested number of characters
+        void reserve(size_t aSize);
+
+    private:
+        std::vector<char>   mData;  ///< Storage of the buffer (with room for the null terminator)
+    };
+
+    /// @{ Non-copyable object
+    Stream(const Stream&);
+    void operator=(const Stream&);
+    /// @}
+
+private:
+    Buffer              mBuffer;    ///< The underlying stream buffer
+    std::ios::fmtflags  mFlags;     ///< Default formatting flags of the stream
+    std::string         mFields;    ///< Encoded key/value fields of the Log
+    std::string         mArgs;      ///< Encoded arguments of the format string of the Log
+};
+
+
+} // namespace Log
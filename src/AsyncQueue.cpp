@@ -0,0 +1,464 @@
+/**
+ * @file    AsyncQueue.cpp
+ * @ingroup LoggerCpp
+ * @brief   Bounded lock-free multi-producer queue drained by a background writer thread
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <LoggerCpp/AsyncQueue.h>
+#include <LoggerCpp/Manager.h>
+#include <LoggerCpp/Exception.h>
+
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace Log {
+
+
+/// Source of the unique ids of the AsyncQueue objects (0 is never used)
+static std::atomic<unsigned long> sNextId(1);
+
+/**
+ * The Ring of the current thread, for the AsyncQueue of the given id
+ *
+ * Its destructor, run at the exit of the thread, marks the ring as closed,
+ * so that the writer thread releases it once it has output its last Log.
+ */
+struct AsyncQueue::ThreadRing {
+    unsigned long   mQueueId;   ///< Id of the AsyncQueue owning the ring (0 if none)
+    RingPtr         mRingPtr;   ///< The ring of the thread
+
+    /// @brief Mark the ring as closed (no more Log will be written into it)
+    void close(void) {
+        if (mRingPtr) {
+            mRingPtr->mbClosed.store(true, std::memory_order_release);
+            mRingPtr.reset();
+        }
+        mQueueId = 0;
+    }
+
+    /// @brief Destructor : close the ring at the exit of the thread
+    ~ThreadRing(void) {
+        close();
+    }
+};
+
+// The Ring of the current thread
+thread_local AsyncQueue::ThreadRing AsyncQueue::mThreadRing = { 0, RingPtr() };
+
+
+// Create the queue and start the writer thread
+AsyncQueue::AsyncQueue(const Config::Ptr& aConfigPtr) :
+    mMask(0),
+    mOverflow(eBlock),
+    mbPerThread(false),
+    mMergeWindow(0),
+    mId(sNextId.fetch_add(1)),
+    mWritePos(0),
+    mReadPos(0),
+    mbSleeping(false),
+    mbStopping(false),
+    mbNewRings(false),
+    mFlushing(0) {
+    assert(aConfigPtr);
+
+    // Round the size of the ring up to the next power of two
+    long queueSize = aConfigPtr->get("queue_size", (long)8192);
+    if (queueSize < 2) {
+        LOGGER_THROW("invalid queue_size " << queueSize);
+    }
+    size_t capacity = 2;
+    while (capacity < static_cast<size_t>(queueSize)) {
+        capacity <<= 1;
+    }
+    mOverflow = toOverflow(aConfigPtr->get("overflow", "block"));
+    const std::string mode = aConfigPtr->get("mode", "shared");
+    if ("per_thread" == mode) {
+        mbPerThread = true;
+    } else if ("shared" != mode) {
+        LOGGER_THROW("Unknown mode '" << mode << "'");
+    }
+    mMergeWindow = aConfigPtr->get("merge_window", (long)10) * 1000000LL;
+
+    // In "per_thread" mode, the rings of the threads are created by getRing()
+    mMask = capacity - 1;
+    if (mbPerThread) {
+        capacity = 0;
+    }
+    std::vector<Slot>(capacity).swap(mSlots);
+    for (size_t idx = 0; idx < capacity; ++idx) {
+        mSlots[idx].mSequence.store(idx, std::memory_order_relaxed);
+    }
+    for (int level = Log::eDebug; level <= Log::eCritic; ++level) {
+        mDroppedCount[level].store(0, std::memory_order_relaxed);
+    }
+
+    mThread = std::thread(&AsyncQueue::run, this);
+}
+
+// Output all pending Log and stop the writer thread
+AsyncQueue::~AsyncQueue(void) {
+    mbStopping.store(true);
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mWakeUp.notify_one();
+    }
+    mThread.join();
+}
+
+// Copy the Log into the queue, to be output by the writer thread
+bool AsyncQueue::push(const Channel::Ptr* apChannelPtr, const Log& aLog) {
+    if (mbPerThread) {
+        return pushRing(apChannelPtr, aLog);
+    }
+
+    const Log::Level severity = aLog.getSeverity();
+
+    // Debug Log are dropped first, before the queue is really full
+    if ((eDropDebugFirst == mOverflow) && (Log::eDebug == severity) && (size() >= (mMask + 1) / 4 * 3)) {
+        mDroppedCount[severity].fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Reserve a slot: it is free when its sequence number is equal to the write position
+    Slot*   pSlot;
+    size_t  pos = mWritePos.load(std::memory_order_relaxed);
+    for (;;) {
+        pSlot = &mSlots[pos & mMask];
+        const size_t    sequence    = pSlot->mSequence.load(std::memory_order_acquire);
+        const ptrdiff_t diff        = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(pos);
+        if (0 == diff) {
+            if (mWritePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (0 > diff) {
+            // The queue is full: the slot has not yet been released by the writer thread
+            if (eDropNewest == mOverflow) {
+                mDroppedCount[severity].fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            wakeUp();
+            std::this_thread::yield();
+            pos = mWritePos.load(std::memory_order_relaxed);
+        } else {
+            // Another producer reserved this slot in between
+            pos = mWritePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Copy the Log into the slot, and publish it to the writer thread
+    store(*pSlot, apChannelPtr, aLog);
+    pSlot->mSequence.store(pos + 1, std::memory_order_release);
+
+    wakeUp();
+
+    return true;
+}
+
+// Copy the Log into a slot
+void AsyncQueue::store(Slot& aSlot, const Channel::Ptr* apChannelPtr, const Log& aLog) {
+    aSlot.mpChannelPtr  = apChannelPtr;
+    aSlot.mSeverity     = aLog.getSeverity();
+    aSlot.mStamp        = aLog.getStamp();
+    aSlot.mpCallSite    = aLog.getCallSite();
+    aSlot.mThreadId     = aLog.getThreadId();
+    aSlot.mpThreadName  = aLog.getThreadName();
+    aSlot.mMessage.assign(aLog.getMessage(), aLog.getMessageSize());
+    aSlot.mTextSize     = aLog.getTextSize();
+    aSlot.mFields.assign(aLog.getFields(), aLog.getFieldsSize());
+    aSlot.mArgs.assign(aLog.getArgs(), aLog.getArgsSize());
+}
+
+// Get the Ring of the current thread, registering a new one on its first Log
+AsyncQueue::Ring& AsyncQueue::getRing(void) {
+    if (mId != mThreadRing.mQueueId) {
+        // Release the ring of a previous AsyncQueue, if any
+        mThreadRing.close();
+
+        RingPtr ringPtr(new Ring());
+        std::vector<Slot>(mMask + 1).swap(ringPtr->mSlots);
+        ringPtr->mWritePos.store(0, std::memory_order_relaxed);
+        ringPtr->mReadCache = 0;
+        ringPtr->mReadPos.store(0, std::memory_order_relaxed);
+        ringPtr->mbClosed.store(false, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(mRingsMutex);
+            mRings.push_back(ringPtr);
+            mNewRings.push_back(ringPtr);
+        }
+        mbNewRings.store(true, std::memory_order_release);
+
+        mThreadRing.mQueueId = mId;
+        mThreadRing.mRingPtr = ringPtr;
+    }
+    return *mThreadRing.mRingPtr;
+}
+
+// Copy the Log into the Ring of the current thread
+bool AsyncQueue::pushRing(const Channel::Ptr* apChannelPtr, const Log& aLog) {
+    const Log::Level    severity    = aLog.getSeverity();
+    Ring&               ring        = getRing();
+    const size_t        pos         = ring.mWritePos.load(std::memory_order_relaxed);
+
+    // Debug Log are dropped first, before the ring is really full
+    if ((eDropDebugFirst == mOverflow) && (Log::eDebug == severity) && (pos - ring.mReadCache >= (mMask + 1) / 4 * 3)) {
+        ring.mReadCache = ring.mReadPos.load(std::memory_order_acquire);
+        if (pos - ring.mReadCache >= (mMask + 1) / 4 * 3) {
+            mDroppedCount[severity].fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    // The ring is full when the writer thread has not yet output the Log written one turn ago
+    while (pos - ring.mReadCache > mMask) {
+        ring.mReadCache = ring.mReadPos.load(std::memory_order_acquire);
+        if (pos - ring.mReadCache <= mMask) {
+            break;
+        }
+        if (eDropNewest == mOverflow) {
+            mDroppedCount[severity].fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        wakeUp();
+        std::this_thread::yield();
+    }
+
+    // Copy the Log into the slot, and publish it to the writer thread
+    store(ring.mSlots[pos & mMask], apChannelPtr, aLog);
+    ring.mWritePos.store(pos + 1, std::memory_order_release);
+
+    wakeUp();
+
+    return true;
+}
+
+// Wait until all the Log pushed before this call have been output
+void AsyncQueue::flush(void) {
+    if (mbPerThread) {
+        // Wait for the writer thread to reach the current write position of each ring, without merge window
+        std::vector<std::pair<RingPtr, size_t> > targets;
+        {
+            std::lock_guard<std::mutex> lock(mRingsMutex);
+            for (std::vector<RingPtr>::const_iterator iRingPtr = mRings.begin(); iRingPtr != mRings.end(); ++iRingPtr) {
+                targets.push_back(std::make_pair(*iRingPtr, (*iRingPtr)->mWritePos.load()));
+            }
+        }
+        mFlushing.fetch_add(1);
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            for (size_t idx = 0; idx < targets.size(); ) {
+                if (targets[idx].first->mReadPos.load() < targets[idx].second) {
+                    mWakeUp.notify_one();
+                    mFlushed.wait(lock);
+                } else {
+                    ++idx;
+                }
+            }
+        }
+        mFlushing.fetch_sub(1);
+        return;
+    }
+
+    const size_t target = mWritePos.load();
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (mReadPos.load() < target) {
+        mWakeUp.notify_one();
+        mFlushed.wait(lock);
+    }
+}
+
+// Wake up the writer thread if it is waiting for new Log
+void AsyncQueue::wakeUp(void) {
+    // Pairs with the fence of the writer thread between setting mbSleeping and checking the queue
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (mbSleeping.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mWakeUp.notify_one();
+    }
+}
+
+// Main loop of the writer thread
+void AsyncQueue::run(void) {
+    if (mbPerThread) {
+        runMerge();
+        return;
+    }
+
+    for (;;) {
+        const size_t    pos     = mReadPos.load(std::memory_order_relaxed);
+        Slot&           slot    = mSlots[pos & mMask];
+        if (slot.mSequence.load(std::memory_order_acquire) == pos + 1) {
+            output(slot);
+            slot.mSequence.store(pos + mMask + 1, std::memory_order_release);
+            mReadPos.store(pos + 1, std::memory_order_release);
+        } else {
+            // The queue is empty: signal flush() waiters, then wait for new Log
+            std::unique_lock<std::mutex> lock(mMutex);
+            mFlushed.notify_all();
+            mbSleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (slot.mSequence.load(std::memory_order_acquire) != pos + 1) {
+                if (mbStopping.load()) {
+                    mbSleeping.store(false, std::memory_order_relaxed);
+                    break;
+                }
+                // The timeout only guards against a missed notification
+                mWakeUp.wait_for(lock, std::chrono::milliseconds(100));
+            }
+            mbSleeping.store(false, std::memory_order_relaxed);
+        }
+    }
+}
+
+// Main loop of the writer thread in "per_thread" mode : merge the rings by timestamp
+void AsyncQueue::runMerge(void) {
+    std::vector<Reader> readers;
+    for (;;) {
+        // Take the rings registered in the meantime
+        if (mbNewRings.exchange(false, std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(mRingsMutex);
+            for (std::vector<RingPtr>::const_iterator iRingPtr = mNewRings.begin();
+                 iRingPtr != mNewRings.end();
+                 ++iRingPtr) {
+                const Reader reader = { *iRingPtr, 0, 0, LLONG_MAX };
+                readers.push_back(reader);
+            }
+            mNewRings.clear();
+        }
+
+        // Output without waiting for the empty rings when flushing or stopping
+        const bool      bStopping   = mbStopping.load();
+        const bool      bFlushing   = (0 < mFlushing.load());
+        const long long bound       = (bStopping || bFlushing) ? LLONG_MAX :
+                                      Clock::now() - Clock::toTicks(mMergeWindow);
+        const size_t    nbOutput    = merge(readers, bound);
+
+        // Release the rings of the exited threads, once empty (their last write is visible once closed)
+        bool bPending = false;
+        for (size_t idx = 0; idx < readers.size(); ) {
+            Reader& reader = readers[idx];
+            if ((reader.mReadPos == reader.mWriteCache) && reader.mRingPtr->mbClosed.load(std::memory_order_acquire)) {
+                reader.mWriteCache = reader.mRingPtr->mWritePos.load(std::memory_order_acquire);
+                if (reader.mReadPos == reader.mWriteCache) {
+                    std::lock_guard<std::mutex> lock(mRingsMutex);
+                    for (size_t ring = 0; ring < mRings.size(); ++ring) {
+                        if (mRings[ring] == reader.mRingPtr) {
+                            mRings.erase(mRings.begin() + ring);
+                            break;
+                        }
+                    }
+                    readers.erase(readers.begin() + idx);
+                    continue;
+                }
+            }
+            bPending = bPending || (reader.mReadPos != reader.mWriteCache);
+            ++idx;
+        }
+
+        if (0 < nbOutput) {
+            if (bFlushing) {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mFlushed.notify_all();
+            }
+        } else {
+            // Nothing to output (yet): signal flush() waiters, then wait for new Log, or for the merge window
+            std::unique_lock<std::mutex> lock(mMutex);
+            mFlushed.notify_all();
+            mbSleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool bNew = mbNewRings.load(std::memory_order_relaxed) || (0 < mFlushing.load());
+            for (size_t idx = 0; (idx < readers.size()) && !bNew; ++idx) {
+                bNew = (readers[idx].mWriteCache != readers[idx].mRingPtr->mWritePos.load(std::memory_order_acquire));
+            }
+            if (!bNew) {
+                if (bStopping && !bPending) {
+                    mbSleeping.store(false, std::memory_order_relaxed);
+                    break;
+                }
+                // The timeout guards against a missed notification, or waits for the merge window
+                mWakeUp.wait_for(lock, bPending ? std::chrono::nanoseconds(mMergeWindow)
+                                                : std::chrono::nanoseconds(std::chrono::milliseconds(100)));
+            }
+            mbSleeping.store(false, std::memory_order_relaxed);
+        }
+    }
+}
+
+// Output the Log of the rings in timestamp order
+size_t AsyncQueue::merge(std::vector<Reader>& aReaders, long long aBound) {
+    // Look only once for new Log in the empty rings, to keep away from the cache lines of their producers
+    for (std::vector<Reader>::iterator iReader = aReaders.begin(); iReader != aReaders.end(); ++iReader) {
+        if (iReader->mReadPos == iReader->mWriteCache) {
+            iReader->mWriteCache = iReader->mRingPtr->mWritePos.load(std::memory_order_acquire);
+            if (iReader->mReadPos != iReader->mWriteCache) {
+                iReader->mHeadStamp = iReader->mRingPtr->mSlots[iReader->mReadPos & mMask].mStamp;
+            }
+        }
+    }
+
+    size_t nbOutput = 0;
+    for (;;) {
+        // The oldest Log at the head of the rings: on a tie, the first registered ring wins,
+        // since the readers are appended in registration order and erased without reordering
+        Reader* pOldest = nullptr;
+        bool    bEmpty  = false;
+        for (std::vector<Reader>::iterator iReader = aReaders.begin(); iReader != aReaders.end(); ++iReader) {
+            if (iReader->mReadPos == iReader->mWriteCache) {
+                bEmpty = true;
+            } else if ((nullptr == pOldest) || (iReader->mHeadStamp < pOldest->mHeadStamp)) {
+                pOldest = &(*iReader);
+            }
+        }
+        if ((nullptr == pOldest) || (bEmpty && (pOldest->mHeadStamp > aBound))) {
+            // Nothing to output, or an empty ring might still receive an older Log
+            break;
+        }
+
+        output(pOldest->mRingPtr->mSlots[pOldest->mReadPos & mMask]);
+        ++pOldest->mReadPos;
+        pOldest->mRingPtr->mReadPos.store(pOldest->mReadPos, std::memory_order_release);
+        if (pOldest->mReadPos == pOldest->mWriteCache) {
+            pOldest->mWriteCache = pOldest->mRingPtr->mWritePos.load(std::memory_order_acquire);
+        }
+        if (pOldest->mReadPos != pOldest->mWriteCache) {
+            pOldest->mHeadStamp = pOldest->mRingPtr->mSlots[pOldest->mReadPos & mMask].mStamp;
+        }
+        ++nbOutput;
+    }
+    return nbOutput;
+}
+
+// Output a Log and release its slot (writer thread only)
+void AsyncQueue::output(Slot& aSlot) {
+    Log log(aSlot.mSeverity, aSlot.mStamp, aSlot.mMessage.c_str(), aSlot.mMessage.size(),
+            aSlot.mTextSize, aSlot.mFields.data(), aSlot.mFields.size(), aSlot.mArgs.data(), aSlot.mArgs.size(),
+            aSlot.mpCallSite);
+    log.mThreadId = aSlot.mThreadId;
+    log.mpThreadName = aSlot.mpThreadName;
+    Manager::dispatch(*aSlot.mpChannelPtr, log);
+}
+
+// Convert an overflow policy string representation to its corresponding value
+AsyncQueue::Overflow AsyncQueue::toOverflow(const char* apOverflow) {
+    AsyncQueue::Overflow overflow;
+
+    if      (0 == strcmp(apOverflow, "block"))              overflow = eBlock;
+    else if (0 == strcmp(apOverflow, "drop_newest"))        overflow = eDropNewest;
+    else if (0 == strcmp(apOverflow, "drop_debug_first"))   overflow = eDropDebugFirst;
+    else LOGGER_THROW("Unknown overflow policy '" << apOverflow << "'");  // NOLINT(whitespace/newline)
+
+    return overflow;
+}
+
+
+} // namespace Log
@@ -0,0 +1,253 @@
+/**
+ * @file    Clock.cpp
+ * @ingroup LoggerCpp
+ * @brief   Raw timestamp capture, calibrated against the wall clock to be converted later to a DateTime
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <LoggerCpp/Clock.h>
+#include <LoggerCpp/Exception.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <time.h>
+
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define LOGGER_HAS_TSC  ///< The time-stamp counter can be read by rdtsc
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define LOGGER_HAS_TSC  ///< The time-stamp counter can be read by rdtsc
+#endif
+
+
+namespace Log {
+
+
+/**
+ * @brief Calibration of the source of the stamps against the wall clock
+ */
+struct Calibration {
+    long long   mBaseStamp;     ///< Stamp of the last synchronization
+    long long   mBaseNano;      ///< Wall clock of the last synchronization, in nanoseconds since the Epoch
+    double      mNanoPerTick;   ///< Rate of the source, in nanoseconds per tick
+    long long   mPeriod;        ///< Number of ticks between two synchronizations (one second)
+};
+
+/// Mutex protecting the shared calibration
+static std::mutex                   sMutex;
+/// The shared calibration, updated by setSource() and by each synchronization
+static Calibration                  sCalibration = { 0, 0, 1.0, 1000000000LL };
+/// Incremented on each update of the shared calibration
+static std::atomic<unsigned int>    sGeneration(0);
+
+/// Copy of the shared calibration used by the current thread
+static thread_local Calibration     sThreadCalibration = { 0, 0, 1.0, 1000000000LL };
+/// Generation of the copy of the shared calibration used by the current thread
+static thread_local unsigned int    sThreadGeneration = 0;
+
+
+std::atomic<Clock::Source> Clock::mSource(Clock::eRealtime);
+
+
+/// Tell if the processor has an invariant time-stamp counter (constant rate, and running in all power states)
+static bool hasInvariantTsc(void) {
+    bool bInvariant = false;
+#if defined(LOGGER_HAS_TSC) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0x80000000);
+    if (0x80000007 <= static_cast<unsigned int>(info[0])) {
+        __cpuid(info, 0x80000007);
+        bInvariant = (0 != (info[3] & (1 << 8)));
+    }
+#elif defined(LOGGER_HAS_TSC)
+    unsigned int eax, ebx, ecx, edx;
+    if (0 != __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+        bInvariant = (0 != (edx & (1U << 8)));
+    }
+#endif
+    return bInvariant;
+}
+
+/// Take the copy of the shared calibration, if it has been updated since
+static inline const Calibration& getCalibration(void) {
+    const unsigned int generation = sGeneration.load(std::memory_order_acquire);
+    if (generation != sThreadGeneration) {
+        std::lock_guard<std::mutex> lock(sMutex);
+        sThreadCalibration  = sCalibration;
+        sThreadGeneration   = sGeneration.load(std::memory_order_relaxed);
+    }
+    return sThreadCalibration;
+}
+
+
+// Select the source of the stamps, and calibrate it against the wall clock
+void Clock::setSource(Source aSource) {
+    if ((eTsc == aSource) && !hasInvariantTsc()) {
+        aSource = eMonotonicRaw;
+    }
+
+    Calibration calibration = { 0, 0, 1.0, 1000000000LL };
+    if (eRealtime != aSource) {
+        // The monotonic clocks count nanoseconds, the rate of the time-stamp counter is measured
+        sample(aSource, calibration.mBaseStamp, calibration.mBaseNano);
+        if (eTsc == aSource) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            long long stamp;
+            long long nano;
+            sample(aSource, stamp, nano);
+            calibration.mNanoPerTick = static_cast<double>(nano - calibration.mBaseNano)
+                                     / static_cast<double>(stamp - calibration.mBaseStamp);
+            calibration.mPeriod     = static_cast<long long>(1000000000.0 / calibration.mNanoPerTick);
+            calibration.mBaseStamp  = stamp;
+            calibration.mBaseNano   = nano;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(sMutex);
+    sCalibration = calibration;
+    mSource.store(aSource, std::memory_order_relaxed);
+    sGeneration.fetch_add(1, std::memory_order_release);
+}
+
+// The source of the stamps
+Clock::Source Clock::getSource(void) {
+    return mSource.load(std::memory_order_relaxed);
+}
+
+// Convert a string representation of a Source to its corresponding value
+Clock::Source Clock::toSource(const char* apSource) {
+    Source source;
+
+    if      (0 == strcmp(apSource, "realtime"))         source = eRealtime;
+    else if (0 == strcmp(apSource, "monotonic_raw"))    source = eMonotonicRaw;
+    else if (0 == strcmp(apSource, "tsc"))              source = eTsc;
+    else LOGGER_THROW("Unknown clock source \"" << apSource << "\"");  // NOLINT(whitespace/newline)
+
+    return source;
+}
+
+// Capture a raw stamp from the current source
+long long Clock::now(void) {
+    return read(mSource.load(std::memory_order_relaxed));
+}
+
+// Capture a raw stamp from the given source
+long long Clock::read(Source aSource) {
+    long long stamp;
+
+    switch (aSource) {
+#ifdef LOGGER_HAS_TSC
+        case eTsc:
+            stamp = static_cast<long long>(__rdtsc());
+            break;
+#endif
+        case eMonotonicRaw: {
+#ifdef __linux__
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+            stamp = now.tv_sec * 1000000000LL + now.tv_nsec;
+#else
+            stamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+            break;
+        }
+        default:
+            stamp = getRealtime();
+            break;
+    }
+
+    return stamp;
+}
+
+// Current wall clock time, in nanoseconds since the Epoch
+long long Clock::getRealtime(void) {
+#ifdef _WIN32
+    // 100 nanoseconds intervals since January 1, 1601 (UTC)
+    FILETIME now;
+    GetSystemTimeAsFileTime(&now);
+    const unsigned long long ticks = (static_cast<unsigned long long>(now.dwHighDateTime) << 32) | now.dwLowDateTime;
+    return static_cast<long long>(ticks - 116444736000000000ULL) * 100;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+#endif
+}
+
+// Convert a stamp to the wall clock, in nanoseconds since the Epoch
+long long Clock::toEpochNano(long long aStamp) {
+    if (eRealtime == mSource.load(std::memory_order_relaxed)) {
+        return aStamp;
+    }
+
+    const Calibration* pCalibration = &getCalibration();
+    if (aStamp - pCalibration->mBaseStamp > pCalibration->mPeriod) {
+        synchronize();
+        pCalibration = &getCalibration();
+    }
+    return pCalibration->mBaseNano + static_cast<long long>(
+        std::floor(static_cast<double>(aStamp - pCalibration->mBaseStamp) * pCalibration->mNanoPerTick));
+}
+
+// Convert a duration in nanoseconds to a difference of stamps
+long long Clock::toTicks(long long aNanoseconds) {
+    if (eRealtime == mSource.load(std::memory_order_relaxed)) {
+        return aNanoseconds;
+    }
+    return static_cast<long long>(static_cast<double>(aNanoseconds) / getCalibration().mNanoPerTick);
+}
+
+// Read the source and the wall clock together, keeping the closest of a few pairs
+void Clock::sample(Source aSource, long long& aStamp, long long& aNano) {
+    long long bestGap = LLONG_MAX;
+    for (int idx = 0; idx < 5; ++idx) {
+        const long long before  = read(aSource);
+        const long long nano    = getRealtime();
+        const long long after   = read(aSource);
+        if (after - before < bestGap) {
+            bestGap = after - before;
+            aStamp  = before + bestGap / 2;
+            aNano   = nano;
+        }
+    }
+}
+
+// Synchronize again the calibration with the wall clock
+void Clock::synchronize(void) {
+    const Source source = mSource.load(std::memory_order_relaxed);
+    long long stamp;
+    long long nano;
+    sample(source, stamp, nano);
+
+    std::lock_guard<std::mutex> lock(sMutex);
+    // Another thread may have just synchronized it
+    if (stamp - sCalibration.mBaseStamp > sCalibration.mPeriod) {
+        // Measure the rate again since the last synchronization, unless the wall clock has been set (1% off)
+        const double nanoPerTick = static_cast<double>(nano - sCalibration.mBaseNano)
+                                 / static_cast<double>(stamp - sCalibration.mBaseStamp);
+        if (std::fabs(nanoPerTick - sCalibration.mNanoPerTick) < sCalibration.mNanoPerTick / 100) {
+            sCalibration.mNanoPerTick = nanoPerTick;
+        }
+        sCalibration.mBaseStamp = stamp;
+        sCalibration.mBaseNano  = nano;
+        sGeneration.fetch_add(1, std::memory_order_release);
+    }
+}
+
+
+} // namespace Log
@@ -1,7 +1,7 @@
 /**
  * @file    DateTime.cpp
  * @ingroup LoggerCpp
- * @brief   Current time precise to the millisecond.
+ * @brief   Current time precise to the nanosecond.
  *
  * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
  *
@@ -10,18 +10,40 @@
  */
 
 #include <LoggerCpp/DateTime.h>
+#include <LoggerCpp/Clock.h>
 #include <LoggerCpp/Utils.h>
 
-#ifdef WIN32
-#include <windows.h>
-#else
 #include <time.h>
-#include <sys/time.h>
-#endif
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
 
 namespace Log {
 
 
+/// Use UTC instead of the local time zone
+static std::atomic<bool> sbUtc(false);
+
+/**
+ * @brief Calendar fields of the current second, cached by each thread
+ */
+struct DateTimeCache {
+    long long   epoch;      ///< seconds since the Epoch of the cached fields (-1 when empty)
+    bool        bUtc;       ///< UTC mode of the cached fields
+    int         year;       ///< year
+    int         month;      ///< month
+    int         day;        ///< day
+    int         hour;       ///< hour
+    int         minute;     ///< minute
+    int         second;     ///< second
+    char        text[20];   ///< "YYYY-MM-DD HH:MM:SS"
+};
+
+/// Calendar fields of the current second, for the current thread
+static thread_local DateTimeCache sCache = { -1, false, 0, 0, 0, 0, 0, 0, { 0 } };
+
+
 /// Constructor
 DateTime::DateTime(void) :
     year(0),
@@ -30,39 +52,69 @@ DateTime::DateTime(void) :
     hour(0),
     minute(0),
     second(0),
-    ms(0),
-    us(0) {
+    ns(0),
+    epoch(0) {
+    text[0] = '\0';
 }
 
 
 /// Set to current time
 void DateTime::make(void) {
+    set(Clock::getRealtime());
+}
+
+/// Set to the given time
+void DateTime::set(long long aEpochNano) {
+    epoch   = aEpochNano / 1000000000LL;
+    ns      = static_cast<int>(aEpochNano % 1000000000LL);
+
+    // Convert to calendar fields only when the second rolls over (or when the UTC mode changes)
+    const bool bUtc = sbUtc.load(std::memory_order_relaxed);
+    if ((epoch != sCache.epoch) || (bUtc != sCache.bUtc)) {
+        const time_t    seconds = static_cast<time_t>(epoch);
+        struct tm       timeinfo;
 #ifdef WIN32
-    SYSTEMTIME now;
-    GetLocalTime(&now);
-
-    year    = now.wYear;
-    month   = now.wMonth;
-    day     = now.wDay;
-    hour    = now.wHour;
-    minute  = now.wMinute;
-    second  = now.wSecond;
-    ms      = now.wMilliseconds;
-    us      = 0;
+        if (bUtc) {
+            gmtime_s(&timeinfo, &seconds);
+        } else {
+            localtime_s(&timeinfo, &seconds);
+        }
 #else
-    struct timeval now;
-    gettimeofday(&now, nullptr);
-    struct tm* timeinfo = localtime(&now.tv_sec);
-
-    year    = timeinfo->tm_year + 1900;
-    month   = timeinfo->tm_mon + 1;
-    day     = timeinfo->tm_mday;
-    hour    = timeinfo->tm_hour;
-    minute  = timeinfo->tm_min;
-    second  = timeinfo->tm_sec;
-    ms      = static_cast<int>(now.tv_usec / 1000);
-    us      = static_cast<int>(now.tv_usec % 1000);
+        if (bUtc) {
+            gmtime_r(&seconds, &timeinfo);
+        } else {
+            localtime_r(&seconds, &timeinfo);
+        }
 #endif
+        sCache.epoch    = epoch;
+        sCache.bUtc     = bUtc;
+        sCache.year     = timeinfo.tm_year + 1900;
+        sCache.month    = timeinfo.tm_mon + 1;
+        sCache.day      = timeinfo.tm_mday;
+        sCache.hour     = timeinfo.tm_hour;
+        sCache.minute   = timeinfo.tm_min;
+        sCache.second   = timeinfo.tm_sec;
+        snprintf(sCache.text, sizeof(sCache.text), "%.4u-%.2u-%.2u %.2u:%.2u:%.2u",
+                 sCache.year, sCache.month, sCache.day, sCache.hour, sCache.minute, sCache.second);
+    }
+
+    year    = sCache.year;
+    month   = sCache.month;
+    day     = sCache.day;
+    hour    = sCache.hour;
+    minute  = sCache.minute;
+    second  = sCache.second;
+    memcpy(text, sCache.text, sizeof(text));
+}
+
+/// Use UTC instead of the local time zone for the calendar fields of all new DateTime
+void DateTime::setUtc(bool abUtc) {
+    sbUtc.store(abUtc, std::memory_order_relaxed);
+}
+
+/// Tell if the calendar fields of new DateTime are in UTC
+bool DateTime::isUtc(void) {
+    return sbUtc.load(std::memory_order_relaxed);
 }
 
 
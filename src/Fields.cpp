@@ -0,0 +1,221 @@
+/**
+ * @file    Fields.cpp
+ * @ingroup LoggerCpp
+ * @brief   Typed key/value fields of a structured Log, encoded in a compact binary buffer
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <LoggerCpp/Fields.h>
+#include <LoggerCpp/Format.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+
+namespace Log {
+
+
+// Number of Output objects formatting the messages themselves
+std::atomic<unsigned int> Fields::mArgsOutputs(0);
+
+// Count an Output formatting the messages from their arguments
+void Fields::addArgsOutput(void) {
+    mArgsOutputs.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Stop counting an Output formatting the messages from their arguments
+void Fields::removeArgsOutput(void) {
+    mArgsOutputs.fetch_sub(1, std::memory_order_relaxed);
+}
+
+// Encode the type and the key of a field
+void Fields::appendKey(std::string& aFields, Type aType, const char* apKey) {
+    size_t keySize = strlen(apKey);
+    if (keySize > 255) {
+        keySize = 255;
+    }
+    aFields.push_back(static_cast<char>(aType));
+    aFields.push_back(static_cast<char>(keySize));
+    aFields.append(apKey, keySize);
+}
+
+// Encode a number field, from its 8 bytes representation
+void Fields::appendNumber(std::string& aFields, Type aType, const char* apKey, const void* apValue) {
+    appendKey(aFields, aType, apKey);
+    aFields.append(static_cast<const char*>(apValue), 8);
+}
+
+// Encode a string field
+void Fields::appendString(std::string& aFields, const char* apKey, const char* apValue, size_t aSize) {
+    const unsigned int size = static_cast<unsigned int>(aSize);
+    appendKey(aFields, eString, apKey);
+    aFields.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    aFields.append(apValue, aSize);
+}
+
+// Decode the next field of a buffer
+bool Fields::next(const char*& apData, const char* apEnd, Field& aField) {
+    if (apEnd - apData < 2) {
+        return false;
+    }
+    aField.type     = static_cast<Type>(apData[0]);
+    aField.keySize  = static_cast<unsigned char>(apData[1]);
+    aField.pKey     = apData + 2;
+    const char* pValue = apData + 2 + aField.keySize;
+    // Check the size of the value, the buffer being read back from a file by the loggercpp-decode tool
+    const size_t available = (apEnd - pValue > 0) ? static_cast<size_t>(apEnd - pValue) : 0;
+
+    switch (aField.type) {
+    case eBool:
+        if (available < 1) {
+            return false;
+        }
+        aField.b = (0 != *pValue);
+        pValue += 1;
+        break;
+    case eInt:
+        if (available < 8) {
+            return false;
+        }
+        memcpy(&aField.i, pValue, 8);
+        pValue += 8;
+        break;
+    case eUint:
+        if (available < 8) {
+            return false;
+        }
+        memcpy(&aField.u, pValue, 8);
+        pValue += 8;
+        break;
+    case eDouble:
+        if (available < 8) {
+            return false;
+        }
+        memcpy(&aField.d, pValue, 8);
+        pValue += 8;
+        break;
+    case eString:
+    default: {
+        unsigned int size;
+        if (available < sizeof(size)) {
+            return false;
+        }
+        memcpy(&size, pValue, sizeof(size));
+        if (available - sizeof(size) < size) {
+            return false;
+        }
+        aField.pString      = pValue + sizeof(size);
+        aField.stringSize   = size;
+        pValue += sizeof(size) + size;
+        break;
+    }
+    }
+    apData = pValue;
+    return true;
+}
+
+/**
+ * @brief Convert an integer, optionally with a decimal point
+ *
+ * @param[out] apBuffer     Buffer of Fields::MAX_CHARS
+ * @param[in]  aValue       Absolute value
+ * @param[in]  abNegative   Sign of the value
+ * @param[in]  aDecimals    Number of digits after the decimal point (0 for an integer)
+ *
+ * @return Number of characters written
+ */
+static size_t toDecimal(char* apBuffer, unsigned long long aValue, bool abNegative, int aDecimals) {
+    char    digits[Fields::MAX_CHARS];
+    char*   pEnd        = digits + sizeof(digits);
+    char*   pBegin      = pEnd;
+    int     nbDigits    = 0;
+    do {
+        *--pBegin = static_cast<char>('0' + (aValue % 10));
+        aValue /= 10;
+        ++nbDigits;
+        if (nbDigits == aDecimals) {
+            *--pBegin = '.';
+        }
+    } while ((0 != aValue) || (nbDigits <= aDecimals));
+    if (abNegative) {
+        *--pBegin = '-';
+    }
+    const size_t size = static_cast<size_t>(pEnd - pBegin);
+    memcpy(apBuffer, pBegin, size);
+    return size;
+}
+
+// Convert a signed integer
+size_t Fields::toChars(char* apBuffer, long long aValue) {
+    // Negate as unsigned to handle the minimum value
+    const unsigned long long value = static_cast<unsigned long long>(aValue);
+    return toDecimal(apBuffer, (aValue < 0) ? (0 - value) : value, (aValue < 0), 0);
+}
+
+// Convert an unsigned integer
+size_t Fields::toChars(char* apBuffer, unsigned long long aValue) {
+    return toDecimal(apBuffer, aValue, false, 0);
+}
+
+// Convert a finite double to the shortest decimal representation that reads back exactly
+size_t Fields::toChars(char* apBuffer, double aValue) {
+    // Values with up to 9 decimals are converted as an integer: the division of this integer by a power of ten
+    // is correctly rounded, like the parsing of its decimal representation, so it reads back to the same double
+    static const double sPow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+    const bool      bNegative   = std::signbit(aValue);
+    const double    value       = std::fabs(aValue);
+    for (int decimals = 0; decimals < 10; ++decimals) {
+        const double scaled = value * sPow10[decimals];
+        if (scaled >= 9007199254740992.0) {  // 2^53
+            break;
+        }
+        const unsigned long long integer = static_cast<unsigned long long>(scaled + 0.5);
+        if (static_cast<double>(integer) / sPow10[decimals] == value) {
+            return toDecimal(apBuffer, integer, bNegative && (0 != integer), decimals);
+        }
+    }
+    // Other values use the fewest significant digits of snprintf() that read back exactly: 17 always do
+    for (int precision = 15; precision < 17; ++precision) {
+        const int size = snprintf(apBuffer, MAX_CHARS, "%.*g", precision, aValue);
+        if (strtod(apBuffer, nullptr) == aValue) {
+            return static_cast<size_t>(size);
+        }
+    }
+    return static_cast<size_t>(snprintf(apBuffer, MAX_CHARS, "%.17g", aValue));
+}
+
+// Render the fields at the end of a text message, as " key=value"
+void Fields::render(Stream& aStream, const char* apFields, size_t aSize) {
+    const char* pEnd = apFields + aSize;
+    Field       field;
+    char        number[MAX_CHARS];
+    while (next(apFields, pEnd, field)) {
+        aStream.append(" ", 1);
+        aStream.append(field.pKey, field.keySize);
+        aStream.append("=", 1);
+        switch (field.type) {
+        case eBool:     Format::write(aStream, "{}", field.b); break;
+        case eInt:      aStream.append(number, toChars(number, field.i)); break;
+        case eUint:     aStream.append(number, toChars(number, field.u)); break;
+        case eDouble:
+            if (std::isfinite(field.d)) {
+                aStream.append(number, toChars(number, field.d));
+            } else {
+                Format::write(aStream, "{}", field.d);
+            }
+            break;
+        case eString:
+        default:        aStream.append(field.pString, field.stringSize); break;
+        }
+    }
+}
+
+
+} // namespace Log
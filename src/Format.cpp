@@ -0,0 +1,253 @@
+/**
+ * @file    Format.cpp
+ * @ingroup LoggerCpp
+ * @brief   Type-safe "{}" format strings, written straight into the Stream of a Log without iostreams
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <LoggerCpp/Format.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+
+namespace Log {
+
+
+/// Specification of a plain "{}" placeholder
+static const Format::Spec sDefaultSpec = { '\0', ' ', '\0', 0, -1 };
+
+/**
+ * @brief Parse the specification of a placeholder "{:[align][0][width][.precision][type]}"
+ *
+ *  Format::close() parses the same grammar at compile time: keep them in sync.
+ *
+ * @param[in]  apFormat The character following the opening brace
+ * @param[out] aSpec    The parsed specification
+ *
+ * @return The closing brace, or nullptr if the placeholder is invalid
+ */
+static const char* parseSpec(const char* apFormat, Format::Spec& aSpec) {
+    aSpec.align     = '\0';
+    aSpec.fill      = ' ';
+    aSpec.type      = '\0';
+    aSpec.width     = 0;
+    aSpec.precision = -1;
+
+    if (':' == *apFormat) {
+        ++apFormat;
+        if (('<' == *apFormat) || ('>' == *apFormat)) {
+            aSpec.align = *apFormat;
+            ++apFormat;
+        }
+        if ('0' == *apFormat) {
+            aSpec.fill = '0';
+            ++apFormat;
+        }
+        while (('0' <= *apFormat) && ('9' >= *apFormat)) {
+            aSpec.width = aSpec.width * 10 + static_cast<size_t>(*apFormat - '0');
+            ++apFormat;
+        }
+        if ('.' == *apFormat) {
+            ++apFormat;
+            aSpec.precision = 0;
+            while (('0' <= *apFormat) && ('9' >= *apFormat)) {
+                aSpec.precision = aSpec.precision * 10 + (*apFormat - '0');
+                ++apFormat;
+            }
+        }
+        if (('\0' != *apFormat) && (nullptr != strchr("dxXobfeg", *apFormat))) {
+            aSpec.type = *apFormat;
+            ++apFormat;
+        }
+    }
+
+    return ('}' == *apFormat) ? apFormat : nullptr;
+}
+
+
+// Write a formatted message into the Stream, with a list of type-erased arguments
+void Format::write(Stream& aStream, const char* apFormat, const Arg* apArgs, size_t aNbArgs) {
+    size_t idxArg = 0;
+    while ('\0' != *apFormat) {
+        // Copy the literal text up to the next brace at once
+        const size_t literal = strcspn(apFormat, "{}");
+        if (0 < literal) {
+            aStream.append(apFormat, literal);
+            apFormat += literal;
+        }
+        if ('\0' == *apFormat) {
+            break;
+        }
+
+        if (('{' == apFormat[0]) && ('}' == apFormat[1]) && (idxArg < aNbArgs)) {
+            // Plain "{}" placeholder, the most common one, without any specification to parse
+            apArgs[idxArg].write(aStream, sDefaultSpec);
+            ++idxArg;
+            apFormat += 2;
+        } else if (apFormat[0] == apFormat[1]) {
+            // "{{" or "}}" escape
+            aStream.append(apFormat, 1);
+            apFormat += 2;
+        } else if ('}' == *apFormat) {
+            // Lone closing brace
+            aStream.append(apFormat, 1);
+            ++apFormat;
+        } else {
+            Spec        spec;
+            const char* pClose = parseSpec(apFormat + 1, spec);
+            if ((nullptr != pClose) && (idxArg < aNbArgs)) {
+                apArgs[idxArg].write(aStream, spec);
+                ++idxArg;
+                apFormat = pClose + 1;
+            } else {
+                // Invalid placeholder, or missing argument: written as is
+                aStream.append(apFormat, 1);
+                ++apFormat;
+            }
+        }
+    }
+}
+
+// Write a boolean as "true" or "false"
+void Format::writeStream(Stream& aStream, const Spec& aSpec, bool abValue) {
+    if (abValue) {
+        writePadded(aStream, aSpec, '<', "true", 4);
+    } else {
+        writePadded(aStream, aSpec, '<', "false", 5);
+    }
+}
+
+// Write a character
+void Format::writeStream(Stream& aStream, const Spec& aSpec, char aValue) {
+    writePadded(aStream, aSpec, '<', &aValue, 1);
+}
+
+// Write a null-terminated string
+void Format::writeStream(Stream& aStream, const Spec& aSpec, const char* apValue) {
+    if (nullptr == apValue) {
+        apValue = "(null)";
+    }
+    writePadded(aStream, aSpec, '<', apValue, strlen(apValue));
+}
+
+// Write a string
+void Format::writeStream(Stream& aStream, const Spec& aSpec, const std::string& aValue) {
+    writePadded(aStream, aSpec, '<', aValue.data(), aValue.size());
+}
+
+// Write an integer, converted by hand
+void Format::writeInteger(Stream& aStream, const Spec& aSpec, unsigned long long aValue, bool abNegative) {
+    if ((0 == aSpec.width) && (('\0' == aSpec.type) || ('d' == aSpec.type))) {
+        aStream.appendInteger(aValue, abNegative);
+        return;
+    }
+
+    char    buffer[72];  // 64 binary digits and a sign
+    char*   pEnd    = buffer + sizeof(buffer);
+    char*   pBegin  = pEnd;
+
+    switch (aSpec.type) {
+    case 'x':
+    case 'X': {
+        const char* pDigits = ('x' == aSpec.type) ? "0123456789abcdef" : "0123456789ABCDEF";
+        do {
+            *--pBegin = pDigits[aValue & 0xF];
+            aValue >>= 4;
+        } while (0 != aValue);
+        break;
+    }
+    case 'o':
+        do {
+            *--pBegin = static_cast<char>('0' + (aValue & 0x7));
+            aValue >>= 3;
+        } while (0 != aValue);
+        break;
+    case 'b':
+        do {
+            *--pBegin = static_cast<char>('0' + (aValue & 0x1));
+            aValue >>= 1;
+        } while (0 != aValue);
+        break;
+    default:
+        pBegin = Stream::toDecimal(aValue, pEnd);
+        break;
+    }
+
+    if (abNegative) {
+        *--pBegin = '-';
+    }
+    writeNumber(aStream, aSpec, pBegin, static_cast<size_t>(pEnd - pBegin));
+}
+
+// Write a floating point value, converted by the Stream without snprintf() for the common values
+void Format::writeFloat(Stream& aStream, const Spec& aSpec, double aValue) {
+    const int   precision = (0 <= aSpec.precision) ? aSpec.precision : 6;
+    char        buffer[Stream::DOUBLE_CHARS];
+    size_t      size = 0;
+    switch (aSpec.type) {
+    case 'f':
+        size = Stream::toFixed(buffer, aValue, precision);
+        break;
+    case 'e': {
+        const int length = snprintf(buffer, sizeof(buffer), "%.*e", precision, aValue);
+        size = ((0 <= length) && (length < static_cast<int>(sizeof(buffer)))) ? static_cast<size_t>(length) : 0;
+        break;
+    }
+    default:
+        size = Stream::toGeneral(buffer, aValue, precision);
+        break;
+    }
+
+    if (0 < size) {
+        writeNumber(aStream, aSpec, buffer, size);
+    } else {
+        // Huge value in fixed notation, or huge precision
+        const char* pFormat = ('f' == aSpec.type) ? "%.*f" : ('e' == aSpec.type) ? "%.*e" : "%.*g";
+        const int   length  = snprintf(nullptr, 0, pFormat, precision, aValue);
+        if (0 < length) {
+            std::string huge(static_cast<size_t>(length) + 1, '\0');
+            snprintf(&huge[0], huge.size(), pFormat, precision, aValue);
+            writeNumber(aStream, aSpec, huge.data(), static_cast<size_t>(length));
+        }
+    }
+}
+
+// Write a converted number, padded to the width of the specification
+void Format::writeNumber(Stream& aStream, const Spec& aSpec, const char* apData, size_t aSize) {
+    // Zero padding goes between the sign and the digits (and not around "inf" or "nan")
+    const size_t sign = ('-' == *apData) ? 1 : 0;
+    if ((aSpec.width > aSize) && ('0' == aSpec.fill) && ('<' != aSpec.align)
+        && ('i' != apData[sign]) && ('n' != apData[sign])) {
+        aStream.append(apData, sign);
+        aStream.append(aSpec.width - aSize, '0');
+        aStream.append(apData + sign, aSize - sign);
+    } else {
+        writePadded(aStream, aSpec, '>', apData, aSize);
+    }
+}
+
+// Write characters, padded to the width of the specification
+void Format::writePadded(Stream& aStream, const Spec& aSpec, char aDefaultAlign, const char* apData, size_t aSize) {
+    if (aSpec.width <= aSize) {
+        aStream.append(apData, aSize);
+        return;
+    }
+    const size_t padding    = aSpec.width - aSize;
+    const char   align      = ('\0' != aSpec.align) ? aSpec.align : aDefaultAlign;
+    if ('>' == align) {
+        aStream.append(padding, ' ');
+    }
+    aStream.append(apData, aSize);
+    if ('<' == align) {
+        aStream.append(padding, ' ');
+    }
+}
+
+
+} // namespace Log
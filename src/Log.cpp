@@ -11,8 +11,21 @@
 
 #include <LoggerCpp/Log.h>
 #include <LoggerCpp/Logger.h>
+#include <LoggerCpp/Manager.h>
 
 #include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+#ifdef _WIN32
+#include <Windows.h>
+#elif defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <cstdint>
+#include <pthread.h>
+#endif
 
 
 namespace Log {
@@ -20,26 +33,169 @@ namespace Log {
 
 // Construct a RAII (private) log object for the Logger class
 Log::Log(const Logger& aLogger, Level aSeverity) :
-    mLogger(aLogger),
+    mpLogger(&aLogger),
     mSeverity(aSeverity),
-    mpStream(nullptr) {
-    // Construct a stream only if the severity of the Log is above its Logger Log::Level
-    if (aSeverity >= aLogger.getLevel()) {
-        mpStream = new(std::ostringstream);
+    mStamp(0),
+    mbTime(false),
+    mpStream(nullptr),
+    mpMessage(""),
+    mMessageSize(0),
+    mTextSize(0),
+    mpFields(""),
+    mFieldsSize(0),
+    mpArgs(""),
+    mArgsSize(0),
+    mpCallSite(nullptr),
+    mThreadId(0),
+    mpThreadName(nullptr) {
+    // Use a stream only if the severity of the Log is above its Logger Log::Level, and it is not sampled out
+    if ((aSeverity >= aLogger.getLevel()) && aLogger.mpChannel->sample(aSeverity)) {
+        mpStream = Stream::acquire();
     }
 }
 
-// Destructor : output the Log string stream
+// Construct a RAII (private) log object for the Logger class, at the source location of a macro
+Log::Log(const Logger& aLogger, const CallSite& aCallSite) :
+    mpLogger(&aLogger),
+    mSeverity(aCallSite.getLevel()),
+    mStamp(0),
+    mbTime(false),
+    mpStream(nullptr),
+    mpMessage(""),
+    mMessageSize(0),
+    mTextSize(0),
+    mpFields(""),
+    mFieldsSize(0),
+    mpArgs(""),
+    mArgsSize(0),
+    mpCallSite(&aCallSite),
+    mThreadId(0),
+    mpThreadName(nullptr) {
+    // Use a stream only if the CallSite is enabled (by its State or by the Logger Log::Level), and it is not sampled out
+    if (aLogger.isEnabled(aCallSite) && aLogger.mpChannel->sample(mSeverity)) {
+        mpStream = Stream::acquire();
+    }
+}
+
+// Construct a copy of a Log replayed by the AsyncQueue writer thread
+Log::Log(Level aSeverity, long long aStamp, const char* apMessage, size_t aMessageSize, size_t aTextSize,
+         const char* apFields, size_t aFieldsSize, const char* apArgs, size_t aArgsSize, const CallSite* apCallSite) :
+    mpLogger(nullptr),
+    mSeverity(aSeverity),
+    mStamp(aStamp),
+    mbTime(false),
+    mpStream(nullptr),
+    mpMessage(apMessage),
+    mMessageSize(aMessageSize),
+    mTextSize(aTextSize),
+    mpFields(apFields),
+    mFieldsSize(aFieldsSize),
+    mpArgs(apArgs),
+    mArgsSize(aArgsSize),
+    mpCallSite(apCallSite),
+    mThreadId(getCurrentThreadId()),
+    mpThreadName(getCurrentThreadName()) {
+}
+
+// Destructor : output the Log message
 Log::~Log(void) {
     if (nullptr != mpStream) {
-        mTime.make();
-        mLogger.output(*this);
-
-        delete mpStream;
+        mStamp = Clock::now();
+        mThreadId = getCurrentThreadId();
+        mpThreadName = getCurrentThreadName();
+        // Render the key/value fields at the end of the text, for the text outputs
+        const std::string& fields = mpStream->fields();
+        mTextSize       = mpStream->size();
+        mpFields        = fields.data();
+        mFieldsSize     = fields.size();
+        if (!fields.empty()) {
+            Fields::render(*mpStream, mpFields, mFieldsSize);
+        }
+        mpArgs          = mpStream->args().data();
+        mArgsSize       = mpStream->args().size();
+        mpMessage       = mpStream->c_str();
+        mMessageSize    = mpStream->size();
+        mpLogger->output(*this);
+
+        Stream::release(mpStream);
         mpStream = nullptr;
     }
 }
 
+/// @brief The text header last rendered by a thread, see Log::getHeader()
+struct RenderedHeader {
+    long long           mStamp;         ///< Raw stamp of the Log
+    const std::string*  mpChannelName;  ///< Name of the underlying Channel of the Log (nullptr if none rendered yet)
+    Log::Level          mSeverity;      ///< Severity of the Log
+    std::string         mText;          ///< The text header, its capacity reused by the following Log
+};
+
+// Render the text header of the Log once, "YYYY-MM-DD HH:MM:SS.mmm  Channel      LEVL "
+const char* Log::getHeader(const std::string& aChannelName, size_t& aSize) const {
+    static thread_local RenderedHeader sHeader = { 0, nullptr, eDebug, std::string() };
+    if ((sHeader.mStamp != mStamp) || (sHeader.mpChannelName != &aChannelName) || (sHeader.mSeverity != mSeverity)) {
+        std::string& text = sHeader.mText;
+        text.clear();
+
+        // Date and time, then milliseconds
+        const DateTime& time = getTime();
+        const unsigned int ms = static_cast<unsigned int>(time.ns) / 1000000;
+        text.append(time.text, HEADER_TIME_SIZE - 6);
+        text.push_back('.');
+        text.push_back(static_cast<char>('0' + ms / 100));
+        text.push_back(static_cast<char>('0' + (ms / 10) % 10));
+        text.push_back(static_cast<char>('0' + ms % 10));
+        text.append("  ", 2);
+
+        // Channel name, left-aligned on 12 characters, then the Level
+        text.append(aChannelName);
+        if (aChannelName.size() < 12) {
+            text.append(12 - aChannelName.size(), ' ');
+        }
+        text.push_back(' ');
+        text.append(toString(mSeverity), 4);
+        text.push_back(' ');
+
+        sHeader.mStamp          = mStamp;
+        sHeader.mpChannelName   = &aChannelName;
+        sHeader.mSeverity       = mSeverity;
+    }
+    aSize = sHeader.mText.size();
+    return sHeader.mText.data();
+}
+
+// Id of the calling thread, cached by each thread
+unsigned long Log::getCurrentThreadId(void) {
+    static thread_local unsigned long sThreadId = 0;
+    if (0 == sThreadId) {
+#ifdef _WIN32
+        sThreadId = GetCurrentThreadId();
+#elif defined(__linux__)
+        sThreadId = static_cast<unsigned long>(syscall(SYS_gettid));
+#elif defined(__APPLE__)
+        uint64_t id = 0;
+        pthread_threadid_np(nullptr, &id);
+        sThreadId = static_cast<unsigned long>(id);
+#else
+        sThreadId = static_cast<unsigned long>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+#endif
+    }
+    return sThreadId;
+}
+
+/// Padded name of the calling thread, see Manager::setThreadName()
+static thread_local const char* sThreadName = nullptr;
+
+// Name of the calling thread
+const char* Log::getCurrentThreadName(void) {
+    return sThreadName;
+}
+
+// Set the name of the calling thread
+void Log::setCurrentThreadName(const char* apName) {
+    sThreadName = apName;
+}
+
 // Convert a Level to its string representation
 const char* Log::toString(Log::Level aLevel) {
     const char* pString = nullptr;
@@ -22,13 +22,11 @@ namespace Log {
 Logger::Logger(const char* apChannelName) {
     assert(nullptr != apChannelName);
 
-    mChannelPtr = Manager::get(apChannelName);
+    // The shared pointer returned lives in the table of the Manager, which is never freed
+    mpChannelPtr = &Manager::get(apChannelName);
+    mpChannel    = mpChannelPtr->get();
 
-    assert(mChannelPtr);
-}
-
-// Non virtual destructor
-Logger::~Logger(void) {
+    assert(nullptr != mpChannel);
 }
 
 // Utility const method to produce Log objets, used to collect the stream to output
@@ -51,9 +49,20 @@ Log Logger::critic(void) const {
     return Log(*this, Log::eCritic);
 }
 
+// Produce a Log at the source location of a LOG_xxx() macro
+Log Logger::log(const CallSite& aCallSite) const {
+    return Log(*this, aCallSite);
+}
+
+// Register a CallSite on its first execution, and tell if it is enabled
+bool Logger::registerCallSite(const CallSite& aCallSite) const {
+    Manager::registerCallSite(aCallSite, getName());
+    return isEnabled(aCallSite);
+}
+
 // To be used only by the Log class
 void Logger::output(const Log& aLog) const {
-    Manager::output(mChannelPtr, aLog);
+    Manager::output(*mpChannelPtr, aLog);
 }
 
 
@@ -14,24 +14,157 @@
 
 #include <LoggerCpp/OutputConsole.h>
 #include <LoggerCpp/OutputFile.h>
+#include <LoggerCpp/OutputBinary.h>
+#include <LoggerCpp/OutputJson.h>
+#include <LoggerCpp/OutputMsgPack.h>
 
+#ifdef LOGGERCPP_WITH_SQLITE
+#include <LoggerCpp/OutputSqlite.h>
+#endif
 #ifdef __unix__
 #include <LoggerCpp/OutputSyslog.h>
+#include <LoggerCpp/OutputMmapFile.h>
+#endif
+#ifdef __linux__
+#include <pthread.h>
 #endif
 #ifdef WIN32
 #include <LoggerCpp/OutputDebug.h>
 #endif
 
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
 
 
 namespace Log {
 
 
-Channel::Map    Manager::mChannelMap;
-Output::Vector  Manager::mOutputList;
-Log::Level      Manager::mDefaultLevel = Log::eDebug;
+/// @brief The background thread ticking the Output objects every TICK_PERIOD, see Output::tick()
+struct Manager::Ticker {
+    std::mutex              mMutex;         ///< Mutex protecting the wait of the thread
+    std::condition_variable mWakeUp;        ///< Condition to wake up the thread when it shall stop
+    bool                    mbStopping;     ///< The thread shall stop
+    std::thread             mThread;        ///< The ticking thread, started last
+
+    /// @brief Start the ticking thread
+    Ticker(void) :
+        mbStopping(false),
+        mThread(&Ticker::run, this) {
+    }
+
+    /// @brief Stop the ticking thread
+    ~Ticker(void) {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mbStopping = true;
+        }
+        mWakeUp.notify_one();
+        mThread.join();
+    }
+
+    /// @brief Main loop of the ticking thread
+    void run(void) {
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (!mbStopping) {
+            mWakeUp.wait_for(lock, std::chrono::milliseconds(TICK_PERIOD));
+            if (!mbStopping) {
+                lock.unlock();
+                Manager::tick();
+                lock.lock();
+            }
+        }
+    }
+};
+
+
+/**
+ * @brief Protect the current list of Output objects from reclaim() while reading it (RAII)
+ *
+ *  The reader registers itself in the counter of the current epoch of its stripe, and checks that the epoch
+ * has not changed parity meanwhile (else it registers again) before loading the list: the grace period of reclaim()
+ * advances the epoch twice and waits each time for the counters of the previous parity to drop to 0,
+ * so that it waits for all the readers registered before it started, whatever their parity.
+ * The counters are split into stripes so that the logging threads do not contend on a single cache line.
+ */
+class Manager::ListReader {
+public:
+    /// @brief Register the thread as a reader of the current epoch, then load the current list
+    ListReader(void) :
+        mpCount(nullptr),
+        mpList(nullptr) {
+        ReaderCount& readers = mReaders[getStripe()];
+        for (;;) {
+            const unsigned long parity = mEpoch.load() & 1;
+            mpCount = &readers.mCount[parity];
+            mpCount->fetch_add(1);
+            if (parity == (mEpoch.load() & 1)) {
+                break;
+            }
+            // The epoch advanced before the registration was visible: reclaim() might not be waiting for it
+            mpCount->fetch_sub(1, std::memory_order_release);
+        }
+        mpList = mpOutputList.load();
+    }
+
+    /// @brief Unregister the thread
+    ~ListReader(void) {
+        mpCount->fetch_sub(1, std::memory_order_release);
+    }
+
+    /// @brief The current list of Output objects (or nullptr)
+    inline const OutputList* get(void) const {
+        return mpList;
+    }
+
+private:
+    /// @brief Stripe of the counters of the current thread, assigned round-robin
+    static size_t getStripe(void) {
+        static std::atomic<size_t>  sNextStripe(0);
+        static thread_local size_t  sStripe = sNextStripe.fetch_add(1, std::memory_order_relaxed) & (READER_STRIPES - 1);
+        return sStripe;
+    }
+
+    /// @{ Non-copyable object
+    ListReader(const ListReader&);
+    void operator=(const ListReader&);
+    /// @}
+
+private:
+    std::atomic<long>*  mpCount;    ///< Counter of the readers of the stripe and of the epoch
+    const OutputList*   mpList;     ///< The list of Output objects (or nullptr)
+};
+
+
+const size_t            Manager::MAX_OUTPUTS;
+const size_t            Manager::READER_STRIPES;
+const size_t            Manager::MAX_THREAD_NAMES;
+const long              Manager::TICK_PERIOD;
+std::atomic<const Manager::OutputList*> Manager::mpOutputList(nullptr);
+Manager::ReaderCount                Manager::mReaders[Manager::READER_STRIPES];
+std::atomic<unsigned long>          Manager::mEpoch(0);
+std::mutex                          Manager::mConfigMutex;
+std::vector<const Manager::OutputList*> Manager::mRetiredLists;
+std::recursive_mutex                Manager::mReclaimMutex;
+std::atomic<AsyncQueue*>            Manager::mpAsyncQueue(nullptr);
+Manager::Ticker*                    Manager::mpTicker = nullptr;
+std::atomic<Log::Level>             Manager::mDefaultLevel(Log::eDebug);
+std::vector<const CallSite*>        Manager::mCallSites;
+std::vector<std::string>            Manager::mCallSiteChannels;
+std::vector<Manager::CallSiteQuery> Manager::mCallSiteQueries;
+std::mutex                          Manager::mCallSitesMutex;
+char                                Manager::mThreadNames[MAX_THREAD_NAMES][Log::THREAD_NAME_SIZE];
+size_t                              Manager::mNbThreadNames = 0;
+std::mutex                          Manager::mThreadNamesMutex;
 
 
 // Create and configure the Output objects.
@@ -39,15 +172,31 @@ void Manager::configure(const Config::Vector& aConfigList) {
     // List of all Output class ; those names are in the form
     // - "class Log::OutputConsole" under Visual Studio 2010
     // - "N3Log13OutputConsoleE" under GCC
-    std::string outputConsole = typeid(OutputConsole).name();
-    std::string outputFile    = typeid(OutputFile).name();
+    std::string outputConsole   = typeid(OutputConsole).name();
+    std::string outputFile      = typeid(OutputFile).name();
+    std::string outputBinary    = typeid(OutputBinary).name();
+    std::string outputJson      = typeid(OutputJson).name();
+    std::string outputMsgPack   = typeid(OutputMsgPack).name();
+#ifdef LOGGERCPP_WITH_SQLITE
+    std::string outputSqlite    = typeid(OutputSqlite).name();
+#endif
 #ifdef __unix__
-    std::string outputSyslog  = typeid(OutputSyslog).name();
+    std::string outputSyslog    = typeid(OutputSyslog).name();
+    std::string outputMmapFile  = typeid(OutputMmapFile).name();
 #endif
 #ifdef WIN32
-    std::string outputDebug   = typeid(OutputDebug).name();
+    std::string outputDebug     = typeid(OutputDebug).name();
 #endif
 
+    if (aConfigList.size() > MAX_OUTPUTS) {
+        LOGGER_THROW("Too many Output (" << aConfigList.size() << " > " << MAX_OUTPUTS << ")");
+    }
+
+    OutputList*                     pOutputList = new OutputList();
+    std::unique_ptr<OutputList>     outputListPtr(pOutputList);
+    for (size_t level = Log::eDebug; level <= Log::eCritic; ++level) {
+        pOutputList->mLevelRoutes[level] = 0;
+    }
     Config::Vector::const_iterator  iConfig;
     for (  iConfig  = aConfigList.begin();
            iConfig != aConfigList.end();
@@ -60,9 +209,21 @@ void Manager::configure(const Config::Vector& aConfigList) {
             outputPtr.reset(new OutputConsole((*iConfig)));
         } else if (std::string::npos != outputFile.find(configName)) {
             outputPtr.reset(new OutputFile((*iConfig)));
+        } else if (std::string::npos != outputBinary.find(configName)) {
+            outputPtr.reset(new OutputBinary((*iConfig)));
+        } else if (std::string::npos != outputJson.find(configName)) {
+            outputPtr.reset(new OutputJson((*iConfig)));
+        } else if (std::string::npos != outputMsgPack.find(configName)) {
+            outputPtr.reset(new OutputMsgPack((*iConfig)));
+#ifdef LOGGERCPP_WITH_SQLITE
+        } else if (std::string::npos != outputSqlite.find(configName)) {
+            outputPtr.reset(new OutputSqlite((*iConfig)));
+#endif
 #ifdef __unix__
         } else if (std::string::npos != outputSyslog.find(configName)) {
             outputPtr.reset(new OutputSyslog((*iConfig)));
+        } else if (std::string::npos != outputMmapFile.find(configName)) {
+            outputPtr.reset(new OutputMmapFile((*iConfig)));
 #endif
 #ifdef WIN32
         } else if (std::string::npos != outputDebug.find(configName)) {
@@ -71,58 +232,571 @@ void Manager::configure(const Config::Vector& aConfigList) {
         } else {
             LOGGER_THROW("Unknown Output name '" << configName << "'");
         }
-        mOutputList.push_back(outputPtr);
+
+        // Routing options of the Output
+        const unsigned long long    bit     = 1ULL << pOutputList->mOutputs.size();
+        const Log::Level            level   = Log::toLevel((*iConfig)->get("level", "DBUG"));
+        for (size_t routeLevel = level; routeLevel <= Log::eCritic; ++routeLevel) {
+            pOutputList->mLevelRoutes[routeLevel] |= bit;
+        }
+        pOutputList->mChannels.push_back((*iConfig)->get("channels", "*"));
+        pOutputList->mOutputs.push_back(outputPtr);
+    }
+
+    {
+        // Publish the new list
+        std::lock_guard<std::mutex> lock(mConfigMutex);
+        static unsigned long long sGeneration = 0;
+        ++sGeneration;
+        pOutputList->mTag = (sGeneration & 0xFFFF) << MAX_OUTPUTS;
+        const OutputList* pPreviousList = mpOutputList.exchange(outputListPtr.release());
+
+        // Route the existing Channel objects to the new Output objects
+        for (size_t idx = 0; idx < CHANNEL_SHARDS; ++idx) {
+            ChannelShard& shard = getChannelShards()[idx];
+            std::lock_guard<std::mutex> shardLock(shard.mMutex);
+            Channel::Map::const_iterator iChannel;
+            for (iChannel  = shard.mMap.begin();
+                 iChannel != shard.mMap.end();
+                 ++iChannel) {
+                iChannel->second->setRoutes(pOutputList->route(iChannel->second->getName()));
+            }
+        }
+
+        if (nullptr != pPreviousList) {
+            retire(pPreviousList);
+        }
+
+        if (nullptr == mpTicker) {
+            mpTicker = new Ticker();
+        }
     }
+
+    // Then destroy the previous list, closing its files, once the threads still using it are done with it
+    reclaim();
+}
+
+/**
+ * @brief Match a Channel name against a glob pattern
+ *
+ * @param[in] apPattern     Pattern, with '*' matching any sequence of characters and '?' any single character
+ * @param[in] apPatternEnd  End of the pattern
+ * @param[in] apName        Channel name, null-terminated
+ *
+ * @return true if the name matches the pattern
+ */
+static bool matchGlob(const char* apPattern, const char* apPatternEnd, const char* apName) {
+    // Backtrack only to the last '*', which is enough for glob patterns
+    const char* pStar       = nullptr;
+    const char* pStarName   = nullptr;
+    while ('\0' != *apName) {
+        if ((apPattern != apPatternEnd) && (('?' == *apPattern) || (*apName == *apPattern))) {
+            ++apPattern;
+            ++apName;
+        } else if ((apPattern != apPatternEnd) && ('*' == *apPattern)) {
+            pStar       = apPattern;
+            ++apPattern;
+            pStarName   = apName;
+        } else if (nullptr != pStar) {
+            apPattern   = pStar + 1;
+            ++pStarName;
+            apName      = pStarName;
+        } else {
+            return false;
+        }
+    }
+    while ((apPattern != apPatternEnd) && ('*' == *apPattern)) {
+        ++apPattern;
+    }
+    return (apPattern == apPatternEnd);
+}
+
+// Compute the route of a Channel : its generation tag and the bits of the Output objects matching it
+unsigned long long Manager::OutputList::route(const std::string& aChannelName) const {
+    unsigned long long routes = mTag;
+    for (size_t idx = 0; idx < mChannels.size(); ++idx) {
+        // Comma separated list of patterns
+        const char* pPattern = mChannels[idx].c_str();
+        const char* pEnd     = pPattern + mChannels[idx].size();
+        while (pPattern < pEnd) {
+            const char* pComma = strchr(pPattern, ',');
+            if (nullptr == pComma) {
+                pComma = pEnd;
+            }
+            while ((pPattern < pComma) && (' ' == *pPattern)) {
+                ++pPattern;
+            }
+            if (matchGlob(pPattern, pComma, aChannelName.c_str())) {
+                routes |= 1ULL << idx;
+                break;
+            }
+            pPattern = pComma + 1;
+        }
+    }
+    return routes;
+}
+
+// Switch to asynchronous output of Log objects, by a background writer thread.
+void Manager::configureAsync(const Config::Ptr& aConfigPtr) {
+    std::lock_guard<std::mutex> lock(mConfigMutex);
+    if (nullptr != mpAsyncQueue.load()) {
+        LOGGER_THROW("asynchronous mode already configured");
+    }
+    mpAsyncQueue.store(new AsyncQueue(aConfigPtr));
+}
+
+// Wait until all the Log produced before this call have been output.
+void Manager::flush(void) {
+    // Report the repetitions of the last Log of the Channel objects collapsing them, and the Log sampled out
+    report(true);
+
+    AsyncQueue* pAsyncQueue = mpAsyncQueue.load();
+    if ((nullptr != pAsyncQueue) && !pAsyncQueue->isWriterThread()) {
+        pAsyncQueue->flush();
+    }
+
+    // Then write the Log buffered by the Output objects
+    const ListReader reader;
+    if (nullptr != reader.get()) {
+        flush(reader.get()->mOutputs);
+    }
+}
+
+// Report the pending repetitions and the Log sampled out of the Channel objects
+void Manager::report(bool abFlush) {
+    // The Channel objects are referenced in the table, where they can be queued by the AsyncQueue
+    std::vector<const Channel::Ptr*> channels;
+    for (size_t idx = 0; idx < CHANNEL_SHARDS; ++idx) {
+        ChannelShard& shard = getChannelShards()[idx];
+        std::lock_guard<std::mutex> lock(shard.mMutex);
+        Channel::Map::const_iterator iChannel;
+        for (iChannel  = shard.mMap.begin();
+             iChannel != shard.mMap.end();
+             ++iChannel) {
+            if ((abFlush && iChannel->second->getCollapse()) || (Log::eDebug != iChannel->second->getSampleBelow())) {
+                channels.push_back(&iChannel->second);
+            }
+        }
+    }
+    std::vector<const Channel::Ptr*>::const_iterator iChannelPtr;
+    for (  iChannelPtr  = channels.begin();
+           iChannelPtr != channels.end();
+         ++iChannelPtr) {
+        if (abFlush) {
+            Log::Level  repeatedLevel;
+            const long  repeated = (**iChannelPtr)->takeRepeated(repeatedLevel);
+            if (0 < repeated) {
+                outputRepeated(**iChannelPtr, repeatedLevel, repeated);
+            }
+        }
+        const long  sampledOut = (**iChannelPtr)->takeSampledOut(abFlush);
+        if (0 < sampledOut) {
+            outputSampledOut(**iChannelPtr, sampledOut);
+        }
+    }
+}
+
+// Write the Log buffered by the provided Output objects
+void Manager::flush(const Output::Vector& aOutputList) {
+    Output::Vector::const_iterator  iOutputPtr;
+    for (  iOutputPtr  = aOutputList.begin();
+           iOutputPtr != aOutputList.end();
+         ++iOutputPtr) {
+        (*iOutputPtr)->flush();
+    }
+}
+
+// Queue a replaced list, to be destroyed by reclaim() (with mConfigMutex locked)
+void Manager::retire(const OutputList* apOutputList) {
+    mRetiredLists.push_back(apOutputList);
+}
+
+// Wait until no thread reads the retired lists anymore, then flush and destroy their Output objects
+void Manager::reclaim(void) {
+    // The grace periods are serialized, as each one needs both of its advances of the epoch to be consecutive.
+    // The mutex is recursive, for an Output destroyed here to configure() again from the same thread.
+    std::lock_guard<std::recursive_mutex> reclaimLock(mReclaimMutex);
+    for (;;) {
+        std::vector<const OutputList*> retiredLists;
+        {
+            std::lock_guard<std::mutex> lock(mConfigMutex);
+            retiredLists.swap(mRetiredLists);
+        }
+        if (retiredLists.empty()) {
+            break;
+        }
+
+        // The readers registering from now on are counted in the other parity, and will only load the current list:
+        // wait for the readers of each parity in turn
+        for (int advance = 0; advance < 2; ++advance) {
+            const unsigned long parity = mEpoch.fetch_add(1) & 1;
+            for (;;) {
+                long readers = 0;
+                for (size_t idx = 0; idx < READER_STRIPES; ++idx) {
+                    readers += mReaders[idx].mCount[parity].load();
+                }
+                if (0 == readers) {
+                    break;
+                }
+                std::this_thread::yield();
+            }
+        }
+
+        std::vector<const OutputList*>::const_iterator iOutputList;
+        for (  iOutputList  = retiredLists.begin();
+               iOutputList != retiredLists.end();
+             ++iOutputList) {
+            flush((*iOutputList)->mOutputs);
+            delete *iOutputList;
+        }
+    }
+}
+
+// Tick the current Output objects, and report the Log sampled out once per second (in the ticking thread)
+void Manager::tick(void) {
+    static long sTicks = 0;
+    ++sTicks;
+    if (0 == sTicks % (1000 / TICK_PERIOD)) {
+        report(false);
+    }
+
+    const ListReader reader;
+    if (nullptr != reader.get()) {
+        Output::Vector::const_iterator  iOutputPtr;
+        for (  iOutputPtr  = reader.get()->mOutputs.begin();
+               iOutputPtr != reader.get()->mOutputs.end();
+             ++iOutputPtr) {
+            (*iOutputPtr)->tick();
+        }
+    }
+}
+
+// Number of Log of the given Level dropped because of the overflow policy of the AsyncQueue
+unsigned long Manager::getDroppedCount(Log::Level aLevel) {
+    unsigned long count = 0;
+    AsyncQueue* pAsyncQueue = mpAsyncQueue.load();
+    if (nullptr != pAsyncQueue) {
+        count = pAsyncQueue->getDroppedCount(aLevel);
+    }
+    return count;
+}
+
+// Number of Log lost by the current Output objects because of a failure to write them
+unsigned long Manager::getFailedCount(void) {
+    unsigned long count = 0;
+    std::lock_guard<std::mutex> lock(mConfigMutex);
+    const OutputList* pOutputList = mpOutputList.load();
+    if (nullptr != pOutputList) {
+        Output::Vector::const_iterator  iOutputPtr;
+        for (  iOutputPtr  = pOutputList->mOutputs.begin();
+               iOutputPtr != pOutputList->mOutputs.end();
+             ++iOutputPtr) {
+            count += (*iOutputPtr)->getFailedCount();
+        }
+    }
+    return count;
 }
 
 // Destroy the Output objects.
 void Manager::terminate(void) {
+    // Stop the ticking thread first, so that nothing is written after the final flush
+    {
+        std::lock_guard<std::mutex> lock(mConfigMutex);
+        delete mpTicker;
+        mpTicker = nullptr;
+    }
+
+    // This outputs all the pending Log and stops the writer thread
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(mConfigMutex);
+        delete mpAsyncQueue.exchange(nullptr);
+
+        const OutputList* pOutputList = mpOutputList.exchange(nullptr);
+        if (nullptr != pOutputList) {
+            retire(pOutputList);
+        }
+    }
+
     // This effectively destroys the Output objects
-    mOutputList.clear();
+    reclaim();
+}
+
+// The shards of the map of Channel objects, never freed so that Logger objects can use them until the very end
+Manager::ChannelShard* Manager::getChannelShards(void) {
+    static ChannelShard* const spChannelShards = new ChannelShard[CHANNEL_SHARDS];
+    return spChannelShards;
 }
 
 // Return the Channel corresponding to the provided name
-Channel::Ptr Manager::get(const char* apChannelName) {
-    Channel::Ptr            ChannelPtr;
-    Channel::Map::iterator  iChannelPtr = mChannelMap.find(apChannelName);
+const Channel::Ptr& Manager::get(const char* apChannelName) {
+    // Use the high bits of the hash to select the shard, as the low ones select the bucket inside the map
+    const size_t    hash    = Channel::Hash()(apChannelName);
+    ChannelShard&   shard   = getChannelShards()[(hash >> 7) & (CHANNEL_SHARDS - 1)];
 
-    if (mChannelMap.end() != iChannelPtr) {
-        ChannelPtr = iChannelPtr->second;
-    } else {
-        /// @todo Add a basic thread-safety security (throw if multiple threads create Loggers)
-        ChannelPtr.reset(new Channel(apChannelName, mDefaultLevel));
-        mChannelMap[apChannelName] = ChannelPtr;
+    std::lock_guard<std::mutex> lock(shard.mMutex);
+    Channel::Map::iterator  iChannelPtr = shard.mMap.find(apChannelName);
+    if (shard.mMap.end() == iChannelPtr) {
+        Channel::Ptr ChannelPtr(new Channel(apChannelName, mDefaultLevel.load(std::memory_order_relaxed)));
+        const ListReader reader;
+        if (nullptr != reader.get()) {
+            ChannelPtr->setRoutes(reader.get()->route(ChannelPtr->getName()));
+        }
+        // The key is the name interned by the Channel, which lives as long as the map
+        iChannelPtr = shard.mMap.insert(Channel::Map::value_type(ChannelPtr->getName().c_str(), ChannelPtr)).first;
     }
 
-    return ChannelPtr;
+    // The elements of an unordered_map never move, and are never erased from it
+    return iChannelPtr->second;
+}
+
+/// @brief Hash a message for the collapsing of identical consecutive Log (FNV-1a, 64 bits)
+static unsigned long long hashMessage(const char* apMessage, size_t aSize) {
+    unsigned long long hash = 14695981039346656037ULL;
+    for (size_t idx = 0; idx < aSize; ++idx) {
+        hash = (hash ^ static_cast<unsigned char>(apMessage[idx])) * 1099511628211ULL;
+    }
+    return hash;
 }
 
 // Output the Log to all the active Output objects.
 void Manager::output(const Channel::Ptr& aChannelPtr, const Log& aLog) {
-    Output::Vector::iterator    iOutputPtr;
+    if (aChannelPtr->getCollapse()) {
+        Log::Level  repeatedLevel;
+        const long  repeated = aChannelPtr->collapse(hashMessage(aLog.getMessage(), aLog.getMessageSize()),
+                                                     aLog.getSeverity(), repeatedLevel);
+        if (0 > repeated) {
+            return;
+        } else if (0 < repeated) {
+            outputRepeated(aChannelPtr, repeatedLevel, repeated);
+        }
+    }
+    if (Log::eDebug != aChannelPtr->getSampleBelow()) {
+        const long sampledOut = aChannelPtr->takeSampledOut(false);
+        if (0 < sampledOut) {
+            outputSampledOut(aChannelPtr, sampledOut);
+        }
+    }
+    send(aChannelPtr, aLog);
+}
 
-    for (  iOutputPtr  = mOutputList.begin();
-           iOutputPtr != mOutputList.end();
-         ++iOutputPtr) {
-        (*iOutputPtr)->output(aChannelPtr, aLog);
+// Register a CallSite on its first execution, giving it its unique id and the State of the latest matching query
+void Manager::registerCallSite(const CallSite& aCallSite, const std::string& aChannelName) {
+    std::lock_guard<std::mutex> lock(mCallSitesMutex);
+    // Another thread may have just registered it
+    if (0 == aCallSite.mId.load(std::memory_order_relaxed)) {
+        for (const char* pChar = aCallSite.mpFile; '\0' != *pChar; ++pChar) {
+            if (('/' == *pChar) || ('\\' == *pChar)) {
+                aCallSite.mpBaseName = pChar + 1;
+            }
+        }
+        CallSite::State state = CallSite::eDefault;
+        for (size_t idx = 0; idx < mCallSiteQueries.size(); ++idx) {
+            if (mCallSiteQueries[idx].match(aCallSite, aChannelName)) {
+                state = mCallSiteQueries[idx].mState;
+            }
+        }
+        mCallSites.push_back(&aCallSite);
+        mCallSiteChannels.push_back(aChannelName);
+        aCallSite.mId.store(static_cast<unsigned int>(mCallSites.size()), std::memory_order_release);
+        aCallSite.mState.store(static_cast<unsigned char>(state), std::memory_order_release);
+    }
+}
+
+// The CallSite of the LOG_xxx() macros executed since startup, in order of their id
+std::vector<const CallSite*> Manager::getCallSites(void) {
+    std::lock_guard<std::mutex> lock(mCallSitesMutex);
+    return mCallSites;
+}
+
+// The CallSite of the LOG_xxx() macros executed since startup matching a query
+std::vector<const CallSite*> Manager::getCallSites(const char* apQuery) {
+    const CallSiteQuery query(apQuery, CallSite::eDefault);
+    std::vector<const CallSite*> callSites;
+    std::lock_guard<std::mutex> lock(mCallSitesMutex);
+    for (size_t idx = 0; idx < mCallSites.size(); ++idx) {
+        if (query.match(*mCallSites[idx], mCallSiteChannels[idx])) {
+            callSites.push_back(mCallSites[idx]);
+        }
+    }
+    return callSites;
+}
+
+// Enable or disable the LOG_xxx() macros matching a query, now and on their first execution
+size_t Manager::setCallSites(const char* apQuery, CallSite::State aState) {
+    if (CallSite::eUnregistered == aState) {
+        LOGGER_THROW("Invalid State of the call sites '" << apQuery << "'");
+    }
+    const CallSiteQuery query(apQuery, aState);
+    size_t matches = 0;
+    std::lock_guard<std::mutex> lock(mCallSitesMutex);
+    for (size_t idx = 0; idx < mCallSiteQueries.size(); ++idx) {
+        if (mCallSiteQueries[idx].mQuery == query.mQuery) {
+            mCallSiteQueries.erase(mCallSiteQueries.begin() + idx);
+            break;
+        }
+    }
+    mCallSiteQueries.push_back(query);
+    for (size_t idx = 0; idx < mCallSites.size(); ++idx) {
+        if (query.match(*mCallSites[idx], mCallSiteChannels[idx])) {
+            mCallSites[idx]->mState.store(static_cast<unsigned char>(aState), std::memory_order_release);
+            ++matches;
+        }
     }
+    return matches;
 }
 
-// Serialize the current Log::Level of Channel objects and return them as a Config instance
+// Parse a query of space separated "key=value" selectors
+Manager::CallSiteQuery::CallSiteQuery(const char* apQuery, CallSite::State aState) :
+    mQuery(apQuery),
+    mFile("*"),
+    mFunction("*"),
+    mChannel("*"),
+    mFirstLine(0),
+    mLastLine(INT_MAX),
+    mState(aState) {
+    std::istringstream  stream(mQuery);
+    std::string         option;
+    while (stream >> option) {
+        const size_t        equal = option.find('=');
+        const std::string   key   = option.substr(0, equal);
+        const std::string   value = (std::string::npos != equal) ? option.substr(equal + 1) : "";
+        if ("file" == key) {
+            mFile = value;
+        } else if ("function" == key) {
+            mFunction = value;
+        } else if ("channel" == key) {
+            mChannel = value;
+        } else if ("line" == key) {
+            // "N" or "N-M"
+            const size_t dash = value.find('-');
+            mFirstLine  = atoi(value.c_str());
+            mLastLine   = (std::string::npos != dash) ? atoi(value.c_str() + dash + 1) : mFirstLine;
+        } else {
+            LOGGER_THROW("Unknown selector '" << key << "' of the call sites '" << mQuery << "'");
+        }
+    }
+}
+
+// Tell if a registered CallSite, executed first by the given Channel, matches the query
+bool Manager::CallSiteQuery::match(const CallSite& aCallSite, const std::string& aChannelName) const {
+    // The full path is matched only by a pattern with a directory
+    const char* pFile = (std::string::npos != mFile.find('/')) ? aCallSite.getFile() : aCallSite.getBaseName();
+    return (mFirstLine <= aCallSite.getLine()) && (aCallSite.getLine() <= mLastLine)
+        && matchGlob(mFile.data(), mFile.data() + mFile.size(), pFile)
+        && matchGlob(mFunction.data(), mFunction.data() + mFunction.size(), aCallSite.getFunction())
+        && matchGlob(mChannel.data(), mChannel.data() + mChannel.size(), aChannelName.c_str());
+}
+
+// Name the calling thread, keeping its padded name for good in the table of thread names
+bool Manager::setThreadName(const char* apName) {
+    const std::string name(apName, strnlen(apName, Log::THREAD_NAME_SIZE));
+    const char* pName = nullptr;
+    if (!name.empty()) {
+        std::string padded(name);
+        padded.resize(Log::THREAD_NAME_SIZE, ' ');
+        std::lock_guard<std::mutex> lock(mThreadNamesMutex);
+        for (size_t idx = 0; (idx < mNbThreadNames) && (nullptr == pName); ++idx) {
+            if (0 == memcmp(mThreadNames[idx], padded.data(), Log::THREAD_NAME_SIZE)) {
+                pName = mThreadNames[idx];
+            }
+        }
+        if ((nullptr == pName) && (mNbThreadNames < MAX_THREAD_NAMES)) {
+            memcpy(mThreadNames[mNbThreadNames], padded.data(), Log::THREAD_NAME_SIZE);
+            pName = mThreadNames[mNbThreadNames];
+            ++mNbThreadNames;
+        }
+    }
+    Log::setCurrentThreadName(pName);
+#ifdef __linux__
+    if (!name.empty()) {
+        pthread_setname_np(pthread_self(), name.c_str());
+    }
+#endif
+    return name.empty() || (nullptr != pName);
+}
+
+// Output a "last message repeated N times" Log
+void Manager::outputRepeated(const Channel::Ptr& aChannelPtr, Log::Level aLevel, long aRepeated) {
+    char        message[64];
+    const int   size = snprintf(message, sizeof(message), "last message repeated %ld times", aRepeated);
+    const Log   log(aLevel, Clock::now(), message, static_cast<size_t>(size), static_cast<size_t>(size),
+                    "", 0, "", 0, nullptr);
+    send(aChannelPtr, log);
+}
+
+// Output a "sampled out N Log" report
+void Manager::outputSampledOut(const Channel::Ptr& aChannelPtr, long aSampledOut) {
+    char        message[64];
+    const int   size = snprintf(message, sizeof(message), "sampled out %ld Log below %s",
+                                aSampledOut, Log::toString(aChannelPtr->getSampleBelow()));
+    const Log   log(Log::eNotice, Clock::now(), message, static_cast<size_t>(size), static_cast<size_t>(size),
+                    "", 0, "", 0, nullptr);
+    send(aChannelPtr, log);
+}
+
+// Push the Log to the AsyncQueue, or dispatch it to the Output objects.
+void Manager::send(const Channel::Ptr& aChannelPtr, const Log& aLog) {
+    // A Log produced by an Output in the writer thread is dispatched directly, it could not wait for itself
+    AsyncQueue* pAsyncQueue = mpAsyncQueue.load(std::memory_order_acquire);
+    if ((nullptr != pAsyncQueue) && !pAsyncQueue->isWriterThread()) {
+        pAsyncQueue->push(&aChannelPtr, aLog);
+    } else {
+        dispatch(aChannelPtr, aLog);
+    }
+}
+
+// Dispatch the Log to all the active Output objects routed to its Channel (in the thread calling it).
+void Manager::dispatch(const Channel::Ptr& aChannelPtr, const Log& aLog) {
+    const ListReader    reader;
+    const OutputList*   pOutputList = reader.get();
+    if (nullptr != pOutputList) {
+        // The route of the Channel is computed again only if it is from another list (configured concurrently)
+        unsigned long long routes = aChannelPtr->getRoutes();
+        if ((routes & ~((1ULL << MAX_OUTPUTS) - 1)) != pOutputList->mTag) {
+            routes = pOutputList->route(aChannelPtr->getName());
+            aChannelPtr->setRoutes(routes);
+        }
+        routes &= pOutputList->mLevelRoutes[aLog.getSeverity()];
+        for (size_t idx = 0; 0 != routes; ++idx, routes >>= 1) {
+            if (0 != (routes & 1)) {
+                pOutputList->mOutputs[idx]->output(aChannelPtr, aLog);
+            }
+        }
+    }
+}
+
+// Serialize the current Log::Level and options of Channel objects and return them as a Config instance
 Config::Ptr Manager::getChannelConfig(void) {
     Config::Ptr ConfigPtr(new Config("ChannelConfig"));
 
-    Channel::Map::const_iterator iChannel;
-    for (iChannel  = mChannelMap.begin();
-         iChannel != mChannelMap.end();
-         ++iChannel) {
-        ConfigPtr->setValue(iChannel->first.c_str(), Log::toString(iChannel->second->getLevel()));
+    for (size_t idx = 0; idx < CHANNEL_SHARDS; ++idx) {
+        ChannelShard& shard = getChannelShards()[idx];
+        std::lock_guard<std::mutex> lock(shard.mMutex);
+        Channel::Map::const_iterator iChannel;
+        for (iChannel  = shard.mMap.begin();
+             iChannel != shard.mMap.end();
+             ++iChannel) {
+            const Channel::Ptr& ChannelPtr = iChannel->second;
+            std::string         value = Log::toString(ChannelPtr->getLevel());
+            if (ChannelPtr->getCollapse()) {
+                value += " collapse=1";
+            }
+            if (Log::eDebug != ChannelPtr->getSampleBelow()) {
+                std::ostringstream options;
+                options << " sample=" << ChannelPtr->getSampleRate()
+                        << " sample_below=" << Log::toString(ChannelPtr->getSampleBelow())
+                        << " sample_period=" << ChannelPtr->getSamplePeriod();
+                value += options.str();
+            }
+            ConfigPtr->setValue(iChannel->first, value.c_str());
+        }
     }
 
     return ConfigPtr;
 }
 
-// Set the Log::Level of Channel objects from the provided Config instance
+// Set the Log::Level and options of Channel objects from the provided Config instance
 void Manager::setChannelConfig(const Config::Ptr& aConfigPtr) {
     const Config::Values& ConfigValues = aConfigPtr->getValues();
 
@@ -130,7 +804,35 @@ void Manager::setChannelConfig(const Config::Ptr& aConfigPtr) {
     for (iValue  = ConfigValues.begin();
          iValue != ConfigValues.end();
          ++iValue) {
-        Manager::get(iValue->first.c_str())->setLevel(Log::toLevel(iValue->second.c_str()));
+        Channel::Ptr ChannelPtr = Manager::get(iValue->first.c_str());
+
+        // "LEVEL [key=value]..."
+        std::istringstream  stream(iValue->second);
+        std::string         option;
+        stream >> option;
+        ChannelPtr->setLevel(Log::toLevel(option.c_str()));
+        bool        bCollapse       = false;
+        double      sampleRate      = 1.0;
+        Log::Level  sampleBelow     = Log::eWarning;
+        long        samplePeriod    = 60;
+        while (stream >> option) {
+            const size_t        equal = option.find('=');
+            const std::string   key   = option.substr(0, equal);
+            const std::string   value = (std::string::npos != equal) ? option.substr(equal + 1) : "1";
+            if ("collapse" == key) {
+                bCollapse = (0 != atol(value.c_str()));
+            } else if ("sample" == key) {
+                sampleRate = atof(value.c_str());
+            } else if ("sample_below" == key) {
+                sampleBelow = Log::toLevel(value.c_str());
+            } else if ("sample_period" == key) {
+                samplePeriod = atol(value.c_str());
+            } else {
+                LOGGER_THROW("Unknown option '" << key << "' of Channel '" << iValue->first << "'");
+            }
+        }
+        ChannelPtr->setCollapse(bCollapse);
+        ChannelPtr->setSampling((1.0 != sampleRate) ? sampleBelow : Log::eDebug, sampleRate, samplePeriod);
     }
 }
 
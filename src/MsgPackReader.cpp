@@ -0,0 +1,203 @@
+/**
+ * @file    MsgPackReader.cpp
+ * @ingroup LoggerCpp
+ * @brief   Streaming reader of the files written by the OutputMsgPack
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <LoggerCpp/MsgPackReader.h>
+#include <LoggerCpp/Exception.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+namespace Log {
+
+
+// Open the file
+MsgPackReader::MsgPackReader(const char* apFilename) :
+    mpFile(nullptr),
+    mFilename(apFilename),
+    mpData(nullptr),
+    mpEnd(nullptr),
+    mOffset(0) {
+    mpFile = fopen(apFilename, "rb");
+    if (nullptr == mpFile) {
+        LOGGER_THROW("file \"" << mFilename << "\" not opened");
+    }
+    // Big reads, to scan the file at the speed of the disk
+    setvbuf(mpFile, nullptr, _IOFBF, 1024*1024);
+    mBuffer.resize(4096);
+}
+
+// Close the file
+MsgPackReader::~MsgPackReader(void) {
+    if (nullptr != mpFile) {
+        fclose(mpFile);
+    }
+}
+
+// Read the next record
+bool MsgPackReader::next(Record& aRecord) {
+    unsigned char prefix[4];
+    const size_t nbRead = fread(prefix, 1, sizeof(prefix), mpFile);
+    if (0 == nbRead) {
+        return false;
+    }
+    const size_t size = (static_cast<size_t>(prefix[0]) << 24) | (static_cast<size_t>(prefix[1]) << 16)
+                      | (static_cast<size_t>(prefix[2]) << 8)  | static_cast<size_t>(prefix[3]);
+    if (mBuffer.size() < size) {
+        mBuffer.resize(size);
+    }
+    if ((sizeof(prefix) != nbRead) || (size != fread(&mBuffer[0], 1, size, mpFile))) {
+        LOGGER_THROW("file \"" << mFilename << "\" truncated after offset " << mOffset);
+    }
+    mpData  = &mBuffer[0];
+    mpEnd   = mpData + size;
+    mOffset += sizeof(prefix) + size;
+
+    aRecord.time        = 0;
+    aRecord.level       = Log::eDebug;
+    aRecord.pChannel    = "";
+    aRecord.channelSize = 0;
+    aRecord.pMessage    = "";
+    aRecord.messageSize = 0;
+    aRecord.fields.clear();
+
+    // A fixmap or a map 16
+    const unsigned char type = readByte();
+    size_t nbEntries;
+    if (0x80 == (type & 0xF0)) {
+        nbEntries = type & 0x0F;
+    } else if (0xDE == type) {
+        nbEntries = static_cast<size_t>(readBigEndian(2));
+    } else {
+        LOGGER_THROW("file \"" << mFilename << "\" corrupted before offset " << mOffset << ": not a map");
+    }
+
+    Fields::Field field;
+    for (size_t idx = 0; idx < nbEntries; ++idx) {
+        readString(field.pKey, field.keySize);
+        readValue(field);
+        if ((4 == field.keySize) && (0 == memcmp(field.pKey, "time", 4)) && (Fields::eInt == field.type)) {
+            aRecord.time = field.i;
+        } else if ((7 == field.keySize) && (0 == memcmp(field.pKey, "channel", 7)) && (Fields::eString == field.type)) {
+            aRecord.pChannel    = field.pString;
+            aRecord.channelSize = field.stringSize;
+        } else if ((5 == field.keySize) && (0 == memcmp(field.pKey, "level", 5)) && (4 == field.stringSize)) {
+            const char level[5] = { field.pString[0], field.pString[1], field.pString[2], field.pString[3], '\0' };
+            aRecord.level = Log::toLevel(level);
+        } else if ((7 == field.keySize) && (0 == memcmp(field.pKey, "message", 7)) && (Fields::eString == field.type)) {
+            aRecord.pMessage    = field.pString;
+            aRecord.messageSize = field.stringSize;
+        } else {
+            aRecord.fields.push_back(field);
+        }
+    }
+    return true;
+}
+
+// Read a byte of the current record
+unsigned char MsgPackReader::readByte(void) {
+    if (mpData >= mpEnd) {
+        LOGGER_THROW("file \"" << mFilename << "\" corrupted before offset " << mOffset << ": record too short");
+    }
+    const unsigned char byte = static_cast<unsigned char>(*mpData);
+    ++mpData;
+    return byte;
+}
+
+// Read a big-endian unsigned integer of the current record
+unsigned long long MsgPackReader::readBigEndian(size_t aSize) {
+    unsigned long long value = 0;
+    for (size_t idx = 0; idx < aSize; ++idx) {
+        value = (value << 8) | readByte();
+    }
+    return value;
+}
+
+// Read a str of the current record
+void MsgPackReader::readString(const char*& apString, size_t& aSize) {
+    const unsigned char type = readByte();
+    if (0xA0 == (type & 0xE0)) {
+        aSize = type & 0x1F;                                    // fixstr
+    } else if ((0xD9 == type) || (0xC4 == type)) {
+        aSize = static_cast<size_t>(readBigEndian(1));          // str 8, bin 8
+    } else if ((0xDA == type) || (0xC5 == type)) {
+        aSize = static_cast<size_t>(readBigEndian(2));          // str 16, bin 16
+    } else if ((0xDB == type) || (0xC6 == type)) {
+        aSize = static_cast<size_t>(readBigEndian(4));          // str 32, bin 32
+    } else {
+        LOGGER_THROW("file \"" << mFilename << "\" corrupted before offset " << mOffset << ": not a string");
+    }
+    if (static_cast<size_t>(mpEnd - mpData) < aSize) {
+        LOGGER_THROW("file \"" << mFilename << "\" corrupted before offset " << mOffset << ": string too long");
+    }
+    apString = mpData;
+    mpData += aSize;
+}
+
+// Read any value of the current record into a field
+void MsgPackReader::readValue(Fields::Field& aField) {
+    const unsigned char type = static_cast<unsigned char>((mpData < mpEnd) ? *mpData : 0xC1);
+    aField.stringSize = 0;
+
+    if ((type < 0x80) || (type >= 0xE0)) {
+        // positive or negative fixint
+        aField.type = Fields::eInt;
+        aField.i    = static_cast<signed char>(readByte());
+    } else if ((0xCC <= type) && (type <= 0xCF)) {
+        // uint 8, 16, 32, 64
+        ++mpData;
+        aField.u = readBigEndian(static_cast<size_t>(1) << (type - 0xCC));
+        if (aField.u <= 0x7FFFFFFFFFFFFFFFULL) {
+            aField.type = Fields::eInt;
+            aField.i    = static_cast<long long>(aField.u);
+        } else {
+            aField.type = Fields::eUint;
+        }
+    } else if ((0xD0 <= type) && (type <= 0xD3)) {
+        // int 8, 16, 32, 64, sign-extended
+        ++mpData;
+        const size_t                size    = static_cast<size_t>(1) << (type - 0xD0);
+        const unsigned long long    value   = readBigEndian(size);
+        const unsigned int          shift   = static_cast<unsigned int>(64 - 8 * size);
+        aField.type = Fields::eInt;
+        aField.i    = static_cast<long long>(value << shift) >> shift;
+    } else if (0xCA == type) {
+        // float 32
+        ++mpData;
+        const unsigned int bits = static_cast<unsigned int>(readBigEndian(4));
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        aField.type = Fields::eDouble;
+        aField.d    = value;
+    } else if (0xCB == type) {
+        // float 64
+        ++mpData;
+        const unsigned long long bits = readBigEndian(8);
+        aField.type = Fields::eDouble;
+        memcpy(&aField.d, &bits, sizeof(aField.d));
+    } else if ((0xC2 == type) || (0xC3 == type)) {
+        ++mpData;
+        aField.type = Fields::eBool;
+        aField.b    = (0xC3 == type);
+    } else if (0xC0 == type) {
+        // nil, as an empty string
+        ++mpData;
+        aField.type     = Fields::eString;
+        aField.pString  = "";
+    } else {
+        aField.type = Fields::eString;
+        readString(aField.pString, aField.stringSize);
+    }
+}
+
+
+} // namespace Log
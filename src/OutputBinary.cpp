@@ -0,0 +1,163 @@
+/**
+ * @file    OutputBinary.cpp
+ * @ingroup LoggerCpp
+ * @brief   Output to a compact binary file, decoded offline by the loggercpp-decode tool
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <LoggerCpp/OutputBinary.h>
+#include <LoggerCpp/CallSite.h>
+#include <LoggerCpp/Fields.h>
+
+#include <cstring>
+
+#include <string>
+
+
+namespace Log {
+
+
+/**
+ * @brief Write an unsigned LEB128 varint
+ *
+ * @param[out] apData   Destination, with room for at least 10 bytes
+ * @param[in]  aValue   Value to encode
+ *
+ * @return Number of bytes written
+ */
+static inline size_t writeVarint(char* apData, unsigned long long aValue) {
+    size_t size = 0;
+    while (aValue >= 0x80) {
+        apData[size] = static_cast<char>((aValue & 0x7F) | 0x80);
+        aValue >>= 7;
+        ++size;
+    }
+    apData[size] = static_cast<char>(aValue);
+    return size + 1;
+}
+
+
+const char OutputBinary::MAGIC[8] = { 'L', 'C', 'P', 'P', 'B', 'I', 'N', 3 };
+
+
+// Open the output file, and ask for the arguments of the format strings
+OutputBinary::OutputBinary(const Config::Ptr& aConfigPtr) :
+    OutputFile(aConfigPtr, "log.bin", "log.old.bin"),
+    mLastTime(0) {
+    Fields::addArgsOutput();
+}
+
+// Destructor : stop asking for the arguments of the format strings
+OutputBinary::~OutputBinary() {
+    Fields::removeArgsOutput();
+}
+
+// Append the header of a new binary file to the buffer, and reset the Channel and CallSite ids and the time base
+void OutputBinary::begin(std::string& aBuffer) const {
+    aBuffer.append(MAGIC, sizeof(MAGIC));
+    aBuffer.push_back(static_cast<char>(DateTime::isUtc() ? eFlagUtc : 0));
+    mChannelIds.clear();
+    mCallSiteIds.clear();
+    mLastTime = 0;
+}
+
+// Append the Log to the buffer, as a binary record
+void OutputBinary::format(std::string& aBuffer, const Channel::Ptr& aChannelPtr, const Log& aLog) const {
+    char    record[48];
+    size_t  size;
+
+    // Define the id of the Channel on its first Log in the file
+    ChannelIdMap::const_iterator iChannelId = mChannelIds.find(aChannelPtr.get());
+    unsigned long channelId;
+    if (mChannelIds.end() != iChannelId) {
+        channelId = iChannelId->second;
+    } else {
+        channelId = static_cast<unsigned long>(mChannelIds.size());
+        mChannelIds[aChannelPtr.get()] = channelId;
+
+        const std::string& name = aChannelPtr->getName();
+        record[0] = static_cast<char>(eRecordChannel);
+        size = 1;
+        size += writeVarint(&record[size], channelId);
+        size += writeVarint(&record[size], name.size());
+        aBuffer.append(record, size);
+        aBuffer.append(name);
+    }
+
+    // Define the id of the CallSite on its first Log in the file
+    const CallSite* pCallSite = aLog.getCallSite();
+    unsigned long callSiteId = 0;
+    if (nullptr != pCallSite) {
+        CallSiteIdMap::const_iterator iCallSiteId = mCallSiteIds.find(pCallSite);
+        if (mCallSiteIds.end() != iCallSiteId) {
+            callSiteId = iCallSiteId->second;
+        } else {
+            callSiteId = static_cast<unsigned long>(mCallSiteIds.size());
+            mCallSiteIds[pCallSite] = callSiteId;
+
+            const size_t fileSize       = strlen(pCallSite->getFile());
+            const size_t functionSize   = strlen(pCallSite->getFunction());
+            record[0] = static_cast<char>(eRecordCallSite);
+            size = 1;
+            size += writeVarint(&record[size], callSiteId);
+            size += writeVarint(&record[size], static_cast<unsigned long long>(pCallSite->getLine()));
+            size += writeVarint(&record[size], fileSize);
+            aBuffer.append(record, size);
+            aBuffer.append(pCallSite->getFile(), fileSize);
+            size = writeVarint(record, functionSize);
+            aBuffer.append(record, size);
+            aBuffer.append(pCallSite->getFunction(), functionSize);
+
+            // Define the format string of a LOGF_xxx() macro once, as a dictionary entry of the file
+            if (nullptr != pCallSite->getFormat()) {
+                const size_t formatSize = strlen(pCallSite->getFormat());
+                record[0] = static_cast<char>(eRecordFormat);
+                size = 1;
+                size += writeVarint(&record[size], callSiteId);
+                size += writeVarint(&record[size], formatSize);
+                aBuffer.append(record, size);
+                aBuffer.append(pCallSite->getFormat(), formatSize);
+            }
+        }
+    }
+
+    // Time difference with the previous Log, zigzag encoded (Log of different threads are not strictly ordered)
+    const long long now     = aLog.getEpochNano();
+    const long long delta   = now - mLastTime;
+    const unsigned long long zigzag = (static_cast<unsigned long long>(delta) << 1)
+                                    ^ static_cast<unsigned long long>(delta >> 63);
+    mLastTime = now;
+
+    // The arguments of a format string are formatted by the decoder (the text of the key/value fields is not)
+    const bool bArgs = (nullptr != pCallSite) && (nullptr != pCallSite->getFormat())
+                    && (0 < aLog.getArgsSize()) && (0 == aLog.getFieldsSize());
+
+    size = 1;
+    size += writeVarint(&record[size], channelId);
+    if (bArgs) {
+        record[0] = static_cast<char>(eRecordLogArgs + aLog.getSeverity());
+        size += writeVarint(&record[size], callSiteId);
+    } else if (nullptr != pCallSite) {
+        record[0] = static_cast<char>(eRecordLogAt + aLog.getSeverity());
+        size += writeVarint(&record[size], callSiteId);
+    } else {
+        record[0] = static_cast<char>(eRecordLog + aLog.getSeverity());
+    }
+    size += writeVarint(&record[size], zigzag);
+    if (bArgs) {
+        size += writeVarint(&record[size], aLog.getArgsSize());
+        aBuffer.append(record, size);
+        aBuffer.append(aLog.getArgs(), aLog.getArgsSize());
+    } else {
+        size += writeVarint(&record[size], aLog.getMessageSize());
+        aBuffer.append(record, size);
+        aBuffer.append(aLog.getMessage(), aLog.getMessageSize());
+    }
+}
+
+
+} // namespace Log
@@ -1,7 +1,7 @@
 /**
  * @file    OutputConsole.cpp
  * @ingroup LoggerCpp
- * @brief   Output to the standard console using fprintf() with stdout
+ * @brief   Output to the standard console (stdout)
  *
  * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
  *
@@ -12,6 +12,7 @@
 #include <LoggerCpp/OutputConsole.h>
 
 #include <cstdio>
+#include <string>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -21,8 +22,8 @@ namespace Log {
 
 
 // Constructor
-OutputConsole::OutputConsole(const Config::Ptr& aConfigPtr) {
-    (void)aConfigPtr;
+OutputConsole::OutputConsole(const Config::Ptr& aConfigPtr) :
+    mPattern(aConfigPtr->get("pattern", Pattern::DEFAULT)) {
 }
 
 // Destructor
@@ -69,26 +70,32 @@ unsigned int OutputConsole::toEscapeCode(Log::Level aLevel) {
 
 #endif // _WIN32
 
-// Output the Log to the standard console using fprintf
+// Output the Log to the standard console, formatted by the pattern and preceded by its color
 void OutputConsole::output(const Channel::Ptr& aChannelPtr, const Log& aLog) const {
-    const DateTime& time = aLog.getTime();
+    // Format the whole Log line in a buffer recycled by the current thread
+    static thread_local std::string sLine;
+    sLine.clear();
 
-    // uses fprintf for atomic thread-safe operation
 #ifdef _WIN32
+    mPattern.format(sLine, aChannelPtr->getName(), aLog);
+    sLine.push_back('\n');
+    // uses a single fwrite for atomic thread-safe operation
     SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), toWin32Attribute(aLog.getSeverity()));
-    fprintf(stdout, "%.4u-%.2u-%.2u %.2u:%.2u:%.2u.%.3u  %-12s %s %s\n",
-#else  // _WIN32
-    fprintf(stdout, "\x1B[%02um%.4u-%.2u-%.2u %.2u:%.2u:%.2u.%.3u  %-12s %s %s\x1b[39m\n",
-            toEscapeCode(aLog.getSeverity()),
-#endif // _WIN32
-            time.year, time.month, time.day,
-            time.hour, time.minute, time.second, time.ms,
-            aChannelPtr->getName().c_str(), Log::toString(aLog.getSeverity()), (aLog.getStream()).str().c_str());
-#ifdef _WIN32
+    fwrite(sLine.data(), 1, sLine.size(), stdout);
     SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-#endif // _WIN32
     fflush(stdout);
+#else  // _WIN32
+    const unsigned int  code    = toEscapeCode(aLog.getSeverity());
+    sLine.append("\x1B[", 2);
+    sLine.push_back(static_cast<char>('0' + code / 10));
+    sLine.push_back(static_cast<char>('0' + code % 10));
+    sLine.push_back('m');
+    mPattern.format(sLine, aChannelPtr->getName(), aLog);
+    sLine.append("\x1b[39m\n", 6);
+    // uses a single fwrite for atomic thread-safe operation
+    fwrite(sLine.data(), 1, sLine.size(), stdout);
+    fflush(stdout);
+#endif // _WIN32
 }
 
-
 } // namespace Log
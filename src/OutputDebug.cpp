@@ -15,15 +15,15 @@
 
 #include <Windows.h>
 
-#include <cstdio>
+#include <string>
 
 
 namespace Log {
 
 
 // Constructor
-OutputDebug::OutputDebug(const Config::Ptr& aConfigPtr) {
-    (void)aConfigPtr;
+OutputDebug::OutputDebug(const Config::Ptr& aConfigPtr) :
+    mPattern(aConfigPtr->get("pattern", Pattern::DEFAULT)) {
 }
 
 // Destructor
@@ -32,16 +32,12 @@ OutputDebug::~OutputDebug() {
 
 // Output the Log to the Visual Studio debugger using OutputDebugString()
 void OutputDebug::output(const Channel::Ptr& aChannelPtr, const Log& aLog) const {
-    const DateTime&     time = aLog.getTime();
-    char                buffer[256];
-
-    // uses snprintf for atomic thread-safe operation
-    _snprintf(buffer, sizeof(buffer), "%.4u-%.2u-%.2u %.2u:%.2u:%.2u.%.3u  %-12s %s %s\n",
-            time.year, time.month, time.day,
-            time.hour, time.minute, time.second, time.ms,
-            aChannelPtr->getName().c_str(), Log::toString(aLog.getSeverity()), (aLog.getStream()).str().c_str());
-    buffer[255] = '\0';
-    OutputDebugStringA(buffer);
+    // Format the Log line in a buffer recycled by the current thread
+    static thread_local std::string sLine;
+    sLine.clear();
+    mPattern.format(sLine, aChannelPtr->getName(), aLog);
+    sLine.push_back('\n');
+    OutputDebugStringA(sLine.c_str());
 }
 
 
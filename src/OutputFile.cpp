@@ -1,7 +1,7 @@
 /**
  * @file    OutputFile.cpp
  * @ingroup LoggerCpp
- * @brief   Output to the standard console using printf
+ * @brief   Output to the a file using fwrite
  *
  * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
  *
@@ -13,8 +13,14 @@
 #include <LoggerCpp/Exception.h>
 
 #include <cstdio>
+#include <string>
 #include <sys/types.h>
 #include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 
 namespace Log {
@@ -22,13 +28,28 @@ namespace Log {
 
 // Open the output file
 OutputFile::OutputFile(const Config::Ptr& aConfigPtr) :
-    mpFile(nullptr) {
+    OutputFile(aConfigPtr, "log.txt", "log.old.txt") {
+}
+
+// Open the output file, with specific default file names
+OutputFile::OutputFile(const Config::Ptr& aConfigPtr, const char* apDefaultFilename, const char* apDefaultFilenameOld) :
+    mpFile(nullptr),
+    mSize(0),
+    mbBegin(true),
+    mPattern(aConfigPtr->get("pattern", Pattern::DEFAULT)) {
     assert(aConfigPtr);
 
     mMaxStartupSize = aConfigPtr->get("max_startup_size",   (long)0);
     mMaxSize        = aConfigPtr->get("max_size",           (long)1024*1024);
-    mFilename       = aConfigPtr->get("filename",           "log.txt");
-    mFilenameOld    = aConfigPtr->get("filename_old",       "log.old.txt");
+    mFilename       = aConfigPtr->get("filename",           apDefaultFilename);
+    mFilenameOld    = aConfigPtr->get("filename_old",       apDefaultFilenameOld);
+    mFlushSize      = aConfigPtr->get("flush_size",         (long)0);
+    mFlushPeriod    = aConfigPtr->get("flush_period",       (long)0);
+    mFlushLevel     = Log::toLevel(aConfigPtr->get("flush_level", "CRIT"));
+
+    // Reserve the buffer once and for all (it only grows for a Log line bigger than the remaining room)
+    mBuffer.reserve(static_cast<size_t>(mFlushSize) + 4096);
+    mLastWrite = std::chrono::steady_clock::now();
 
     // Test the size of the existing log file, rename it and open a new one if needed
     struct stat statFile;
@@ -44,8 +65,18 @@ OutputFile::OutputFile(const Config::Ptr& aConfigPtr) :
     }
 }
 
-// Close the file
+// Write the buffer, synchronize and close the file
 OutputFile::~OutputFile() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    write();
+    if (nullptr != mpFile) {
+        // Make sure the last Log lines are on disk before returning from Manager::terminate()
+#ifdef _WIN32
+        _commit(_fileno(mpFile));
+#else
+        fsync(fileno(mpFile));
+#endif
+    }
     close();
 }
 
@@ -55,11 +86,15 @@ void OutputFile::open() const {
     if (nullptr == mpFile) {
         LOGGER_THROW("file \"" << mFilename << "\" not opened");
     }
+    // The buffering is done by the OutputFile itself, so that each write is a single system call
+    setvbuf(mpFile, nullptr, _IONBF, 0);
+    mbBegin = true;
 }
 
 // Close the file if it is opened
 void OutputFile::close() const {
     if (nullptr != mpFile) {
+        write();
         fclose(mpFile);
         mpFile  = nullptr;
         mSize   = 0;
@@ -76,24 +111,66 @@ void OutputFile::rotate() const {
     open();
 }
 
-// Output the Log to the standard console using printf
+// Write the buffer to the file (with the mutex locked)
+void OutputFile::write() const {
+    if ((nullptr != mpFile) && !mBuffer.empty()) {
+        fwrite(mBuffer.data(), 1, mBuffer.size(), mpFile);
+        mBuffer.clear();
+    }
+    if (0 < mFlushPeriod) {
+        mLastWrite = std::chrono::steady_clock::now();
+    }
+}
+
+// Append the beginning of a new log file to the buffer : nothing for a text file
+void OutputFile::begin(std::string& /*aBuffer*/) const {
+}
+
+// Append the Log to the buffer, as a line of text
+void OutputFile::format(std::string& aBuffer, const Channel::Ptr& aChannelPtr, const Log& aLog) const {
+    mPattern.format(aBuffer, aChannelPtr->getName(), aLog);
+    aBuffer.push_back('\n');
+}
+
+// Output the Log to the file buffer, and write the buffer if needed
 void OutputFile::output(const Channel::Ptr& aChannelPtr, const Log& aLog) const {
-    const DateTime& time = aLog.getTime();
+    std::lock_guard<std::mutex> lock(mMutex);
 
+    // The size of the file includes the buffer, so that the rotation happens at the same Log line as if unbuffered
     if (mSize > mMaxSize) {
         rotate();
     }
 
     if (nullptr != mpFile) {
-        // uses fprintf for atomic thread-safe operation
-        int nbWritten = fprintf(mpFile, "%.4u-%.2u-%.2u %.2u:%.2u:%.2u.%.3u  %-12s %s %s\n",
-                                time.year, time.month, time.day,
-                                time.hour, time.minute, time.second, time.ms,
-                                aChannelPtr->getName().c_str(), Log::toString(aLog.getSeverity()),
-                                (aLog.getStream()).str().c_str());
-        fflush(mpFile);
-
-        mSize += nbWritten;
+        const size_t size = mBuffer.size();
+        if (mbBegin) {
+            begin(mBuffer);
+            mbBegin = false;
+        }
+        format(mBuffer, aChannelPtr, aLog);
+        mSize += static_cast<long>(mBuffer.size() - size);
+
+        if ((static_cast<long>(mBuffer.size()) >= mFlushSize) || (aLog.getSeverity() >= mFlushLevel)) {
+            write();
+        } else if ((0 < mFlushPeriod) && (std::chrono::steady_clock::now() - mLastWrite
+                                          >= std::chrono::milliseconds(mFlushPeriod))) {
+            write();
+        }
+    }
+}
+
+// Write the buffer to the file
+void OutputFile::flush(void) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    write();
+}
+
+// Write the buffer to the file if "flush_period" has elapsed since the last write
+void OutputFile::tick(void) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if ((0 < mFlushPeriod) && !mBuffer.empty()
+        && (std::chrono::steady_clock::now() - mLastWrite >= std::chrono::milliseconds(mFlushPeriod))) {
+        write();
     }
 }
 
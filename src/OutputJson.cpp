@@ -0,0 +1,213 @@
+/**
+ * @file    OutputJson.cpp
+ * @ingroup LoggerCpp
+ * @brief   Output to a JSON Lines file, one JSON object per Log with its typed key/value fields
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <LoggerCpp/OutputJson.h>
+#include <LoggerCpp/Fields.h>
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define LOGGER_JSON_SSE2
+#endif
+
+
+namespace Log {
+
+
+/**
+ * @brief Escape a single character for JSON
+ *
+ * @param[in,out] aBuffer   Destination buffer
+ * @param[in]     aChar     Character to escape (a quote, a backslash or a control character)
+ */
+static void escapeChar(std::string& aBuffer, unsigned char aChar) {
+    switch (aChar) {
+    case '"':   aBuffer.append("\\\"", 2); break;
+    case '\\':  aBuffer.append("\\\\", 2); break;
+    case '\n':  aBuffer.append("\\n", 2);  break;
+    case '\r':  aBuffer.append("\\r", 2);  break;
+    case '\t':  aBuffer.append("\\t", 2);  break;
+    case '\b':  aBuffer.append("\\b", 2);  break;
+    case '\f':  aBuffer.append("\\f", 2);  break;
+    default: {
+        static const char sHex[] = "0123456789abcdef";
+        const char escaped[6] = { '\\', 'u', '0', '0', sHex[aChar >> 4], sHex[aChar & 0xF] };
+        aBuffer.append(escaped, sizeof(escaped));
+        break;
+    }
+    }
+}
+
+/// @brief Index of the lowest bit set in a non-zero mask
+static inline unsigned int lowestBit(unsigned int aMask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned int>(__builtin_ctz(aMask));
+#else
+    unsigned int idx = 0;
+    while (0 == (aMask & (1U << idx))) {
+        ++idx;
+    }
+    return idx;
+#endif
+}
+
+/// @brief Tell if a character needs to be escaped in a JSON string
+static inline bool needEscape(unsigned char aChar) {
+    return (aChar < 0x20) || ('"' == aChar) || ('\\' == aChar);
+}
+
+
+// Append a string to a buffer, escaped for JSON
+void OutputJson::escape(std::string& aBuffer, const char* apData, size_t aSize) {
+    const char* pEnd    = apData + aSize;
+    const char* pCopy   = apData;   // start of the characters not yet copied
+
+#if defined(__AVX2__)
+    const __m256i quote     = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i control   = _mm256_set1_epi8(0x1F);
+    while (pEnd - apData >= 32) {
+        const __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(apData));
+        // (chars <= 0x1F) as unsigned, when max(chars, 0x1F) == 0x1F
+        const __m256i special = _mm256_or_si256(
+                                    _mm256_or_si256(_mm256_cmpeq_epi8(chars, quote), _mm256_cmpeq_epi8(chars, backslash)),
+                                    _mm256_cmpeq_epi8(_mm256_max_epu8(chars, control), control));
+        unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(special));
+        if (0 == mask) {
+            apData += 32;
+            continue;
+        }
+        // Copy up to each character to escape
+        while (0 != mask) {
+            const char* pSpecial = apData + lowestBit(mask);
+            aBuffer.append(pCopy, static_cast<size_t>(pSpecial - pCopy));
+            escapeChar(aBuffer, static_cast<unsigned char>(*pSpecial));
+            pCopy = pSpecial + 1;
+            mask &= mask - 1;
+        }
+        apData += 32;
+    }
+#elif defined(LOGGER_JSON_SSE2)
+    const __m128i quote     = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control   = _mm_set1_epi8(0x1F);
+    while (pEnd - apData >= 16) {
+        const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(apData));
+        // (chars <= 0x1F) as unsigned, when max(chars, 0x1F) == 0x1F
+        const __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chars, quote), _mm_cmpeq_epi8(chars, backslash)),
+                                             _mm_cmpeq_epi8(_mm_max_epu8(chars, control), control));
+        unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(special));
+        if (0 == mask) {
+            apData += 16;
+            continue;
+        }
+        // Copy up to each character to escape
+        while (0 != mask) {
+            const char* pSpecial = apData + lowestBit(mask);
+            aBuffer.append(pCopy, static_cast<size_t>(pSpecial - pCopy));
+            escapeChar(aBuffer, static_cast<unsigned char>(*pSpecial));
+            pCopy = pSpecial + 1;
+            mask &= mask - 1;
+        }
+        apData += 16;
+    }
+#endif
+
+    // Remaining characters (or all of them without SIMD)
+    for (; apData < pEnd; ++apData) {
+        if (needEscape(static_cast<unsigned char>(*apData))) {
+            aBuffer.append(pCopy, static_cast<size_t>(apData - pCopy));
+            escapeChar(aBuffer, static_cast<unsigned char>(*apData));
+            pCopy = apData + 1;
+        }
+    }
+    aBuffer.append(pCopy, static_cast<size_t>(pEnd - pCopy));
+}
+
+
+// Open the output file
+OutputJson::OutputJson(const Config::Ptr& aConfigPtr) :
+    OutputFile(aConfigPtr, "log.json", "log.old.json") {
+}
+
+// Destructor
+OutputJson::~OutputJson() {
+}
+
+// Append the key/value fields of a Log, as ',"key":value' JSON members
+void OutputJson::appendFields(std::string& aBuffer, const char* apFields, size_t aSize) {
+    const char*     pEnd    = apFields + aSize;
+    Fields::Field   field;
+    char            number[Fields::MAX_CHARS];
+    while (Fields::next(apFields, pEnd, field)) {
+        aBuffer.append(",\"", 2);
+        escape(aBuffer, field.pKey, field.keySize);
+        aBuffer.append("\":", 2);
+        switch (field.type) {
+        case Fields::eBool:
+            aBuffer.append(field.b ? "true" : "false");
+            break;
+        case Fields::eInt:
+            aBuffer.append(number, Fields::toChars(number, field.i));
+            break;
+        case Fields::eUint:
+            aBuffer.append(number, Fields::toChars(number, field.u));
+            break;
+        case Fields::eDouble:
+            if (std::isfinite(field.d)) {
+                aBuffer.append(number, Fields::toChars(number, field.d));
+            } else {
+                // NaN and infinities are not valid JSON numbers
+                aBuffer.append("null", 4);
+            }
+            break;
+        case Fields::eString:
+        default:
+            aBuffer.push_back('"');
+            escape(aBuffer, field.pString, field.stringSize);
+            aBuffer.push_back('"');
+            break;
+        }
+    }
+}
+
+// Append the Log to the buffer, as a line of JSON
+void OutputJson::format(std::string& aBuffer, const Channel::Ptr& aChannelPtr, const Log& aLog) const {
+    const DateTime& time = aLog.getTime();
+    char            number[64];
+
+    // "YYYY-MM-DD HH:MM:SS" to ISO 8601 "YYYY-MM-DDTHH:MM:SS.uuuuuu"
+    aBuffer.append("{\"time\":\"", 9);
+    aBuffer.append(time.text, 10);
+    aBuffer.push_back('T');
+    aBuffer.append(time.text + 11, 8);
+    snprintf(number, sizeof(number), ".%.6u%s\",\"channel\":\"", time.ns / 1000, DateTime::isUtc() ? "Z" : "");
+    aBuffer.append(number);
+    const std::string& name = aChannelPtr->getName();
+    escape(aBuffer, name.data(), name.size());
+    aBuffer.append("\",\"level\":\"", 11);
+    aBuffer.append(Log::toString(aLog.getSeverity()), 4);
+    aBuffer.append("\",\"message\":\"", 13);
+    escape(aBuffer, aLog.getMessage(), aLog.getTextSize());
+    aBuffer.push_back('"');
+
+    // Typed key/value fields
+    appendFields(aBuffer, aLog.getFields(), aLog.getFieldsSize());
+    aBuffer.append("}\n", 2);
+}
+
+
+} // namespace Log
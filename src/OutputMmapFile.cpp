@@ -0,0 +1,252 @@
+/**
+ * @file    OutputMmapFile.cpp
+ * @ingroup LoggerCpp
+ * @brief   Output to a memory-mapped, preallocated file, without any write system call
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#ifdef __unix__
+
+#include <LoggerCpp/OutputMmapFile.h>
+#include <LoggerCpp/Exception.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+
+namespace Log {
+
+
+/**
+ * @brief Recover the used size of a log file left at its full size by a crash, and truncate it to this size
+ *
+ * @param[in] aFilename Name of the log file
+ * @param[in] aSize     Size of the log file
+ *
+ * @return Offset following the last non-null byte of the file
+ */
+static size_t recoverUsed(const std::string& aFilename, size_t aSize) {
+    const int fd = ::open(aFilename.c_str(), O_RDWR);
+    if (-1 == fd) {
+        return aSize;
+    }
+    // Scan back the trailing null bytes by chunks, a cleanly closed file ending with a new line
+    char    buffer[4096];
+    size_t  used = aSize;
+    while (0 < used) {
+        const size_t chunk = (used < sizeof(buffer)) ? used : sizeof(buffer);
+        if (static_cast<ssize_t>(chunk) != pread(fd, buffer, chunk, static_cast<off_t>(used - chunk))) {
+            break;
+        }
+        size_t idx = chunk;
+        while ((0 < idx) && ('\0' == buffer[idx - 1])) {
+            --idx;
+        }
+        used -= chunk - idx;
+        if (0 < idx) {
+            break;
+        }
+    }
+    if (used < aSize) {
+        if (0 != ftruncate(fd, static_cast<off_t>(used))) {
+            // Keep the trailing null bytes, they are overwritten by the following Log
+        }
+    }
+    ::close(fd);
+    return used;
+}
+
+// Create and map the first segments of the output file
+OutputMmapFile::OutputMmapFile(const Config::Ptr& aConfigPtr) :
+    mPattern(aConfigPtr->get("pattern", Pattern::DEFAULT)) {
+    assert(aConfigPtr);
+
+    mMaxStartupSize = aConfigPtr->get("max_startup_size",   (long)0);
+    const long size = aConfigPtr->get("max_size",           (long)1024*1024);
+    mFilename       = aConfigPtr->get("filename",           "log.txt");
+    mFilenameOld    = aConfigPtr->get("filename_old",       "log.old.txt");
+    mFilenameNext   = mFilename + ".next";
+    if (size < 4096) {
+        LOGGER_THROW("max_size " << size << " too small for a memory-mapped file");
+    }
+    mMaxSize = static_cast<size_t>(size);
+
+    for (int idx = 0; idx < 2; ++idx) {
+        mSegments[idx].mFd      = -1;
+        mSegments[idx].mpData   = nullptr;
+        mSegments[idx].mUsed.store(0);
+        mSegments[idx].mUsers.store(0);
+    }
+
+    // Test the size of the existing log file, to append to it, or rename it and start a new one
+    size_t          used = 0;
+    struct stat     statFile;
+    if (0 == stat(mFilename.c_str(), &statFile)) {
+        // After a crash, the file was not truncated: resume after its last Log line
+        used = recoverUsed(mFilename, static_cast<size_t>(statFile.st_size));
+        if ((static_cast<long>(used) > mMaxStartupSize) || (used >= mMaxSize)) {
+            remove(mFilenameOld.c_str());
+            rename(mFilename.c_str(), mFilenameOld.c_str());
+            used = 0;
+        }
+    }
+
+    open(mSegments[0], mFilename, used);
+    open(mSegments[1], mFilenameNext, 0);
+    mpCurrent.store(&mSegments[0]);
+}
+
+// Synchronize, truncate and close the file, remove the next segment
+OutputMmapFile::~OutputMmapFile() {
+    Segment* pCurrent = mpCurrent.load();
+    const size_t used = pCurrent->mUsed.load();
+    close(*pCurrent, (used < mMaxSize) ? used : mMaxSize);
+
+    Segment& nextSegment = next(*pCurrent);
+    if (-1 != nextSegment.mFd) {
+        close(nextSegment, 0);
+        remove(mFilenameNext.c_str());
+    }
+}
+
+// Synchronize the used part of the current segment with the file
+void OutputMmapFile::flush(void) const {
+    // Register as a user of the current segment, so that it cannot be closed while synchronized
+    for (;;) {
+        Segment* pSegment = mpCurrent.load();
+        pSegment->mUsers.fetch_add(1);
+        if (pSegment == mpCurrent.load()) {
+            const size_t used = pSegment->mUsed.load();
+            if (0 < used) {
+                msync(pSegment->mpData, (used < mMaxSize) ? used : mMaxSize, MS_SYNC);
+            }
+            pSegment->mUsers.fetch_sub(1);
+            break;
+        }
+        pSegment->mUsers.fetch_sub(1);
+    }
+}
+
+// Create (or reopen) a segment file, preallocate and map it
+void OutputMmapFile::open(Segment& aSegment, const std::string& aFilename, size_t aUsed) const {
+    aSegment.mFd = ::open(aFilename.c_str(), O_RDWR | O_CREAT, 0644);
+    if (-1 == aSegment.mFd) {
+        LOGGER_THROW("file \"" << aFilename << "\" not opened");
+    }
+    // Fall back to a sparse file if the filesystem does not support preallocation
+    if (0 != posix_fallocate(aSegment.mFd, 0, static_cast<off_t>(mMaxSize))) {
+        if (0 != ftruncate(aSegment.mFd, static_cast<off_t>(mMaxSize))) {
+            ::close(aSegment.mFd);
+            aSegment.mFd = -1;
+            LOGGER_THROW("file \"" << aFilename << "\" not resized to " << mMaxSize);
+        }
+    }
+    void* pData = mmap(nullptr, mMaxSize, PROT_READ | PROT_WRITE, MAP_SHARED, aSegment.mFd, 0);
+    if (MAP_FAILED == pData) {
+        ::close(aSegment.mFd);
+        aSegment.mFd = -1;
+        LOGGER_THROW("file \"" << aFilename << "\" not mapped");
+    }
+    aSegment.mpData = static_cast<char*>(pData);
+    aSegment.mUsed.store(aUsed);
+}
+
+// Synchronize, unmap, truncate to its used size and close a segment
+void OutputMmapFile::close(Segment& aSegment, size_t aUsed) const {
+    if (nullptr != aSegment.mpData) {
+        msync(aSegment.mpData, mMaxSize, MS_SYNC);
+        munmap(aSegment.mpData, mMaxSize);
+        aSegment.mpData = nullptr;
+    }
+    if (-1 != aSegment.mFd) {
+        if (0 != ftruncate(aSegment.mFd, static_cast<off_t>(aUsed))) {
+            // Nothing better to do than keeping the trailing null bytes
+        }
+        ::close(aSegment.mFd);
+        aSegment.mFd = -1;
+    }
+}
+
+// Rotate a full segment : swap in the next segment, close, remove, rename, and create a new next segment
+void OutputMmapFile::rotate(Segment& aSegment, size_t aUsed) const {
+    std::lock_guard<std::mutex> lock(mRotateMutex);
+
+    Segment& nextSegment = next(aSegment);
+    if (-1 == nextSegment.mFd) {
+        // The previous rotation failed to create the next segment
+        open(nextSegment, mFilenameNext, 0);
+    }
+    remove(mFilenameOld.c_str());
+    rename(mFilename.c_str(), mFilenameOld.c_str());
+    rename(mFilenameNext.c_str(), mFilename.c_str());
+    mpCurrent.store(&nextSegment);
+
+    // Wait for the threads still copying their Log into the full segment
+    while (0 != aSegment.mUsers.load()) {
+        std::this_thread::yield();
+    }
+    close(aSegment, aUsed);
+
+    // Prepare the next segment now, so that the following rotation only has to swap it in
+    open(aSegment, mFilenameNext, 0);
+}
+
+// Output the Log by copying it in the memory-mapped file
+void OutputMmapFile::output(const Channel::Ptr& aChannelPtr, const Log& aLog) const {
+    // Format the Log line in a buffer recycled by the current thread
+    static thread_local std::string sLine;
+    sLine.clear();
+    mPattern.format(sLine, aChannelPtr->getName(), aLog);
+    // A Log line bigger than a whole segment is truncated
+    size_t lineSize = sLine.size();
+    if (lineSize + 1 > mMaxSize) {
+        lineSize = mMaxSize - 1;
+    }
+    const size_t size = lineSize + 1;
+
+    for (;;) {
+        // Register as a user of the current segment, so that it cannot be closed while in use
+        Segment* pSegment = mpCurrent.load();
+        pSegment->mUsers.fetch_add(1);
+        if (pSegment != mpCurrent.load()) {
+            pSegment->mUsers.fetch_sub(1);
+            continue;
+        }
+
+        const size_t offset = pSegment->mUsed.fetch_add(size);
+        if (offset + size <= mMaxSize) {
+            char* pData = pSegment->mpData + offset;
+            memcpy(pData, sLine.data(), lineSize);
+            pData[size - 1] = '\n';
+            pSegment->mUsers.fetch_sub(1, std::memory_order_release);
+            break;
+        }
+        pSegment->mUsers.fetch_sub(1);
+
+        if (offset <= mMaxSize) {
+            // This Log is the first one not fitting in the segment: its offset is the used size of the segment
+            rotate(*pSegment, offset);
+        } else {
+            // Another thread is rotating the segment
+            while (pSegment == mpCurrent.load()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+}
+
+
+} // namespace Log
+
+#endif // __unix__
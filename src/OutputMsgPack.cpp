@@ -0,0 +1,155 @@
+/**
+ * @file    OutputMsgPack.cpp
+ * @ingroup LoggerCpp
+ * @brief   Output to a file of length-prefixed MessagePack maps, read back by the MsgPackReader
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <LoggerCpp/OutputMsgPack.h>
+#include <LoggerCpp/Fields.h>
+
+#include <cstring>
+#include <string>
+
+
+namespace Log {
+
+
+/**
+ * @brief Append a MessagePack type byte followed by a big-endian integer
+ *
+ * @param[in,out] aBuffer   Destination buffer
+ * @param[in]     aType     MessagePack type byte
+ * @param[in]     aValue    Value to encode
+ * @param[in]     aSize     Number of bytes of the value (1, 2, 4 or 8)
+ */
+static void packBigEndian(std::string& aBuffer, unsigned char aType, unsigned long long aValue, size_t aSize) {
+    char bytes[9];
+    bytes[0] = static_cast<char>(aType);
+    for (size_t idx = aSize; idx > 0; --idx) {
+        bytes[idx] = static_cast<char>(aValue & 0xFF);
+        aValue >>= 8;
+    }
+    aBuffer.append(bytes, aSize + 1);
+}
+
+/// @brief Append a MessagePack str
+static void packString(std::string& aBuffer, const char* apData, size_t aSize) {
+    if (aSize < 32) {
+        aBuffer.push_back(static_cast<char>(0xA0 | aSize));      // fixstr
+    } else if (aSize < 0x100) {
+        packBigEndian(aBuffer, 0xD9, aSize, 1);                 // str 8
+    } else if (aSize < 0x10000) {
+        packBigEndian(aBuffer, 0xDA, aSize, 2);                 // str 16
+    } else {
+        packBigEndian(aBuffer, 0xDB, aSize, 4);                 // str 32
+    }
+    aBuffer.append(apData, aSize);
+}
+
+/// @brief Append a MessagePack unsigned integer, in its most compact form
+static void packUint(std::string& aBuffer, unsigned long long aValue) {
+    if (aValue < 0x80) {
+        aBuffer.push_back(static_cast<char>(aValue));           // positive fixint
+    } else if (aValue < 0x100) {
+        packBigEndian(aBuffer, 0xCC, aValue, 1);                // uint 8
+    } else if (aValue < 0x10000) {
+        packBigEndian(aBuffer, 0xCD, aValue, 2);                // uint 16
+    } else if (aValue < 0x100000000ULL) {
+        packBigEndian(aBuffer, 0xCE, aValue, 4);                // uint 32
+    } else {
+        packBigEndian(aBuffer, 0xCF, aValue, 8);                // uint 64
+    }
+}
+
+/// @brief Append a MessagePack signed integer, in its most compact form
+static void packInt(std::string& aBuffer, long long aValue) {
+    if (aValue >= 0) {
+        packUint(aBuffer, static_cast<unsigned long long>(aValue));
+    } else if (aValue >= -32) {
+        aBuffer.push_back(static_cast<char>(aValue));           // negative fixint
+    } else if (aValue >= -0x80) {
+        packBigEndian(aBuffer, 0xD0, static_cast<unsigned long long>(aValue), 1);  // int 8
+    } else if (aValue >= -0x8000) {
+        packBigEndian(aBuffer, 0xD1, static_cast<unsigned long long>(aValue), 2);  // int 16
+    } else if (aValue >= -0x80000000LL) {
+        packBigEndian(aBuffer, 0xD2, static_cast<unsigned long long>(aValue), 4);  // int 32
+    } else {
+        packBigEndian(aBuffer, 0xD3, static_cast<unsigned long long>(aValue), 8);  // int 64
+    }
+}
+
+/// @brief Append a MessagePack float 64
+static void packDouble(std::string& aBuffer, double aValue) {
+    unsigned long long bits;
+    memcpy(&bits, &aValue, sizeof(bits));
+    packBigEndian(aBuffer, 0xCB, bits, 8);
+}
+
+
+// Open the output file
+OutputMsgPack::OutputMsgPack(const Config::Ptr& aConfigPtr) :
+    OutputFile(aConfigPtr, "log.msgpack", "log.old.msgpack") {
+}
+
+// Destructor
+OutputMsgPack::~OutputMsgPack() {
+}
+
+// Append the Log to the buffer, as a length-prefixed MessagePack map
+void OutputMsgPack::format(std::string& aBuffer, const Channel::Ptr& aChannelPtr, const Log& aLog) const {
+    // Count the key/value fields for the size of the map
+    const char*     pFields     = aLog.getFields();
+    const char*     pEnd        = pFields + aLog.getFieldsSize();
+    Fields::Field   field;
+    size_t          nbEntries   = 4;
+    while (Fields::next(pFields, pEnd, field)) {
+        ++nbEntries;
+    }
+
+    // Room for the size prefix, written once the map is encoded
+    const size_t prefix = aBuffer.size();
+    aBuffer.append(4, '\0');
+
+    if (nbEntries < 16) {
+        aBuffer.push_back(static_cast<char>(0x80 | nbEntries)); // fixmap
+    } else {
+        packBigEndian(aBuffer, 0xDE, nbEntries, 2);             // map 16 (a Log has less than 64k fields)
+    }
+
+    packString(aBuffer, "time", 4);
+    packBigEndian(aBuffer, 0xD3, static_cast<unsigned long long>(aLog.getEpochNano()), 8);
+    packString(aBuffer, "channel", 7);
+    packString(aBuffer, aChannelPtr->getName().data(), aChannelPtr->getName().size());
+    packString(aBuffer, "level", 5);
+    packString(aBuffer, Log::toString(aLog.getSeverity()), 4);
+    packString(aBuffer, "message", 7);
+    packString(aBuffer, aLog.getMessage(), aLog.getTextSize());
+
+    pFields = aLog.getFields();
+    while (Fields::next(pFields, pEnd, field)) {
+        packString(aBuffer, field.pKey, field.keySize);
+        switch (field.type) {
+        case Fields::eBool:     aBuffer.push_back(static_cast<char>(field.b ? 0xC3 : 0xC2)); break;
+        case Fields::eInt:      packInt(aBuffer, field.i);      break;
+        case Fields::eUint:     packUint(aBuffer, field.u);     break;
+        case Fields::eDouble:   packDouble(aBuffer, field.d);   break;
+        case Fields::eString:
+        default:                packString(aBuffer, field.pString, field.stringSize); break;
+        }
+    }
+
+    // Big-endian size of the map
+    const size_t size = aBuffer.size() - prefix - 4;
+    aBuffer[prefix]     = static_cast<char>((size >> 24) & 0xFF);
+    aBuffer[prefix + 1] = static_cast<char>((size >> 16) & 0xFF);
+    aBuffer[prefix + 2] = static_cast<char>((size >> 8) & 0xFF);
+    aBuffer[prefix + 3] = static_cast<char>(size & 0xFF);
+}
+
+
+} // namespace Log
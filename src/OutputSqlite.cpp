@@ -0,0 +1,165 @@
+/**
+ * @file    OutputSqlite.cpp
+ * @ingroup LoggerCpp
+ * @brief   Output to a SQLite database file (db3), with batched transactions
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#ifdef LOGGERCPP_WITH_SQLITE
+
+#include <LoggerCpp/OutputSqlite.h>
+#include <LoggerCpp/OutputJson.h>
+#include <LoggerCpp/Exception.h>
+
+#include <sqlite3.h>
+
+#include <string>
+
+
+namespace Log {
+
+
+// Open the database, create its table and indexes, and prepare the insertion
+OutputSqlite::OutputSqlite(const Config::Ptr& aConfigPtr) :
+    mpDatabase(nullptr),
+    mpInsert(nullptr),
+    mBatchCount(0),
+    mFailedCount(0) {
+    assert(aConfigPtr);
+
+    mFilename       = aConfigPtr->get("filename",       "log.db3");
+    mBatchSize      = aConfigPtr->get("batch_size",     (long)1000);
+    mBatchPeriod    = aConfigPtr->get("batch_period",   (long)1000);
+    mBusyTimeout    = aConfigPtr->get("busy_timeout",   (long)1000);
+    mFlushLevel     = Log::toLevel(aConfigPtr->get("flush_level", "CRIT"));
+
+    if (SQLITE_OK != sqlite3_open(mFilename.c_str(), &mpDatabase)) {
+        const std::string error = (nullptr != mpDatabase) ? sqlite3_errmsg(mpDatabase) : "out of memory";
+        sqlite3_close(mpDatabase);
+        LOGGER_THROW("database \"" << mFilename << "\" not opened: " << error);
+    }
+    // Wait for another connection (a reader checkpointing the WAL) instead of failing immediately
+    sqlite3_busy_timeout(mpDatabase, static_cast<int>(mBusyTimeout));
+
+    // WAL: the commits append to the journal instead of rewriting pages, and readers do not block the logger
+    static const char* const sSchema[] = {
+        "PRAGMA journal_mode=WAL",
+        "PRAGMA synchronous=NORMAL",
+        "CREATE TABLE IF NOT EXISTS log ("
+        "time INTEGER NOT NULL, channel TEXT NOT NULL, level INTEGER NOT NULL, message TEXT, fields TEXT)",
+        "CREATE INDEX IF NOT EXISTS log_time ON log (time)",
+        "CREATE INDEX IF NOT EXISTS log_channel ON log (channel)",
+        "CREATE INDEX IF NOT EXISTS log_level ON log (level)"
+    };
+    for (size_t idx = 0; idx < sizeof(sSchema) / sizeof(sSchema[0]); ++idx) {
+        if (SQLITE_OK != sqlite3_exec(mpDatabase, sSchema[idx], nullptr, nullptr, nullptr)) {
+            fail(sSchema[idx]);
+        }
+    }
+    static const char sInsert[] = "INSERT INTO log (time, channel, level, message, fields) VALUES (?, ?, ?, ?, ?)";
+    if (SQLITE_OK != sqlite3_prepare_v2(mpDatabase, sInsert, sizeof(sInsert), &mpInsert, nullptr)) {
+        fail(sInsert);
+    }
+
+    mFields.reserve(4096);
+}
+
+// Commit the current transaction and close the database
+OutputSqlite::~OutputSqlite() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    commit();
+    sqlite3_finalize(mpInsert);
+    sqlite3_close(mpDatabase);
+}
+
+// Close the database and throw the error of an SQL statement of the constructor
+void OutputSqlite::fail(const char* apSql) {
+    const std::string error = sqlite3_errmsg(mpDatabase);
+    sqlite3_close(mpDatabase);
+    LOGGER_THROW("database \"" << mFilename << "\": " << error << " (" << apSql << ")");
+}
+
+// Commit the current transaction, or roll it back if it can not be committed (with the mutex locked)
+void OutputSqlite::commit() const {
+    // A transaction is open unless the connection is in autocommit mode
+    if (0 == sqlite3_get_autocommit(mpDatabase)) {
+        if (SQLITE_OK != sqlite3_exec(mpDatabase, "COMMIT", nullptr, nullptr, nullptr)) {
+            // A failed COMMIT leaves the transaction open (SQLITE_BUSY): roll it back, losing only this batch,
+            // instead of failing each following BEGIN. Never throw from the logging path
+            sqlite3_exec(mpDatabase, "ROLLBACK", nullptr, nullptr, nullptr);
+            mFailedCount.fetch_add(static_cast<unsigned long>(mBatchCount), std::memory_order_relaxed);
+        }
+    } else {
+        // Some errors (SQLITE_FULL, SQLITE_IOERR...) roll back the whole transaction automatically
+        mFailedCount.fetch_add(static_cast<unsigned long>(mBatchCount), std::memory_order_relaxed);
+    }
+    mBatchCount = 0;
+}
+
+// Insert the Log into the current transaction, and commit it if needed
+void OutputSqlite::output(const Channel::Ptr& aChannelPtr, const Log& aLog) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (0 != sqlite3_get_autocommit(mpDatabase)) {
+        // No transaction is open, or it has been rolled back automatically by an error
+        commit();
+        if (SQLITE_OK != sqlite3_exec(mpDatabase, "BEGIN", nullptr, nullptr, nullptr)) {
+            mFailedCount.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        mBatchStart = std::chrono::steady_clock::now();
+    }
+
+    // Key/value fields as a JSON object, from the ',"key":value' members of the OutputJson
+    mFields.clear();
+    OutputJson::appendFields(mFields, aLog.getFields(), aLog.getFieldsSize());
+
+    const std::string&  name = aChannelPtr->getName();
+    sqlite3_bind_int64(mpInsert, 1, static_cast<sqlite3_int64>(aLog.getEpochNano()));
+    sqlite3_bind_text(mpInsert, 2, name.data(), static_cast<int>(name.size()), SQLITE_STATIC);
+    sqlite3_bind_int(mpInsert, 3, aLog.getSeverity());
+    sqlite3_bind_text(mpInsert, 4, aLog.getMessage(), static_cast<int>(aLog.getTextSize()), SQLITE_STATIC);
+    if (mFields.empty()) {
+        sqlite3_bind_null(mpInsert, 5);
+    } else {
+        mFields[0] = '{';
+        mFields.push_back('}');
+        sqlite3_bind_text(mpInsert, 5, mFields.data(), static_cast<int>(mFields.size()), SQLITE_STATIC);
+    }
+    if (SQLITE_DONE == sqlite3_step(mpInsert)) {
+        ++mBatchCount;
+    } else {
+        mFailedCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    sqlite3_reset(mpInsert);
+
+    if ((mBatchCount >= mBatchSize) || (aLog.getSeverity() >= mFlushLevel)) {
+        commit();
+    } else if ((0 < mBatchPeriod) && (std::chrono::steady_clock::now() - mBatchStart
+                                      >= std::chrono::milliseconds(mBatchPeriod))) {
+        commit();
+    }
+}
+
+// Commit the current transaction
+void OutputSqlite::flush(void) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    commit();
+}
+
+// Commit the current transaction if "batch_period" has elapsed since its beginning
+void OutputSqlite::tick(void) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if ((0 < mBatchPeriod) && (0 < mBatchCount)
+        && (std::chrono::steady_clock::now() - mBatchStart >= std::chrono::milliseconds(mBatchPeriod))) {
+        commit();
+    }
+}
+
+
+} // namespace Log
+
+#endif // LOGGERCPP_WITH_SQLITE
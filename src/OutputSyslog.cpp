@@ -16,9 +16,12 @@
 #include <syslog.h>
 #include <assert.h>
 
+#include <string>
+
 namespace Log {
 
-OutputSyslog::OutputSyslog(const Config::Ptr& aConfigPtr) {
+OutputSyslog::OutputSyslog(const Config::Ptr& aConfigPtr) :
+    mPattern(aConfigPtr->get("pattern", Pattern::DEFAULT_NO_TIME)) {
     assert(aConfigPtr);
 
     mLogname = aConfigPtr->get("syslogname", "LoggerCpp");
@@ -47,10 +50,11 @@ void OutputSyslog::output(const Channel::Ptr& aChannelPtr, const Log& aLog) cons
         case Log::eCritic:  pri = LOG_CRIT;     break;
     }
 
-    // Now write it out to syslog
-    syslog(pri, "%-12s %s %s\n",
-           aChannelPtr->getName().c_str(), Log::toString(aLog.getSeverity()),
-           (aLog.getStream()).str().c_str());
+    // Now write it out to syslog, formatted in a buffer recycled by the current thread
+    static thread_local std::string sLine;
+    sLine.clear();
+    mPattern.format(sLine, aChannelPtr->getName(), aLog);
+    syslog(pri, "%s\n", sLine.c_str());
 }
 
 
@@ -0,0 +1,253 @@
+/**
+ * @file    Pattern.cpp
+ * @ingroup LoggerCpp
+ * @brief   A line layout, compiled once from a pattern string into a flat list of append operations
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <LoggerCpp/Pattern.h>
+#include <LoggerCpp/CallSite.h>
+#include <LoggerCpp/Exception.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+namespace Log {
+
+
+const char* const Pattern::DEFAULT          = "%Y-%m-%d %H:%M:%S.%e  %-12c %l %v";
+const char* const Pattern::DEFAULT_NO_TIME  = "%-12c %l %v";
+
+/// Calendar fields used by the patterns not printing them
+static const DateTime sNoTime;
+
+
+/**
+ * @brief Write an unsigned integer with a fixed number of digits, padded with zeros
+ *
+ * @param[in] apOut     Where to write the digits
+ * @param[in] aValue    Value to write
+ * @param[in] aDigits   Number of digits
+ *
+ * @return End of the written digits
+ */
+static inline char* writeDigits(char* apOut, unsigned int aValue, size_t aDigits) {
+    for (size_t idx = aDigits; idx > 0; --idx) {
+        apOut[idx - 1] = static_cast<char>('0' + aValue % 10);
+        aValue /= 10;
+    }
+    return apOut + aDigits;
+}
+
+// Compile the pattern
+Pattern::Pattern(const char* apPattern) :
+    mMaxSize(0),
+    mHeaderOffset(std::string::npos),
+    mbCalendar(false),
+    mbCallSite(false) {
+    if (0 == strcmp(apPattern, DEFAULT)) {
+        mHeaderOffset = 0;
+    } else if (0 == strcmp(apPattern, DEFAULT_NO_TIME)) {
+        mHeaderOffset = Log::HEADER_TIME_SIZE;
+    }
+
+    for (const char* pChar = apPattern; '\0' != *pChar; ++pChar) {
+        Op op = { eLiteral, false, 0, 0 };
+        if (('%' != *pChar) || ('%' == pChar[1])) {
+            // Literal text, merged with the previous one if any
+            if ('%' == *pChar) {
+                ++pChar;
+            }
+            if (mOps.empty() || (eLiteral != mOps.back().mType)) {
+                op.mOffset = mLiterals.size();
+                mOps.push_back(op);
+            }
+            mLiterals.push_back(*pChar);
+            ++mOps.back().mWidth;
+            ++mMaxSize;
+            continue;
+        }
+
+        // Directive, with an optional minimum width
+        const char* pDirective = pChar;
+        ++pChar;
+        if ('-' == *pChar) {
+            op.mbLeft = true;
+            ++pChar;
+        }
+        while (('0' <= *pChar) && ('9' >= *pChar)) {
+            op.mWidth = op.mWidth * 10 + static_cast<size_t>(*pChar - '0');
+            ++pChar;
+        }
+        switch (*pChar) {
+            case 'Y':   op.mType = eYear;       break;
+            case 'm':   op.mType = eMonth;      break;
+            case 'd':   op.mType = eDay;        break;
+            case 'H':   op.mType = eHour;       break;
+            case 'M':   op.mType = eMinute;     break;
+            case 'S':   op.mType = eSecond;     break;
+            case 'e':   op.mType = eMilli;      break;
+            case 'f':   op.mType = eMicro;      break;
+            case 'N':   op.mType = eNano;       break;
+            case 'E':   op.mType = eEpochNano;  break;
+            case 't':   op.mType = eThread;     break;
+            case 'T':   op.mType = eThreadName; break;
+            case 's':   op.mType = eFile;       break;
+            case 'g':   op.mType = eFullFile;   break;
+            case '#':   op.mType = eLine;       break;
+            case '!':   op.mType = eFunction;   break;
+            case 'c':   op.mType = eChannel;    break;
+            case 'l':   op.mType = eLevel;      break;
+            case 'v':   op.mType = eMessage;    break;
+            case '\0':
+                LOGGER_THROW("pattern \"" << apPattern << "\": incomplete directive at its end");
+            default:
+                LOGGER_THROW("pattern \"" << apPattern << "\": unknown directive \""
+                             << std::string(pDirective, pChar + 1) << "\"");
+        }
+        if ((0 != op.mWidth) && ((eEpochNano > op.mType) || (eThreadName == op.mType))) {
+            LOGGER_THROW("pattern \"" << apPattern << "\": no width allowed for \""
+                         << std::string(pDirective, pChar + 1) << "\"");
+        }
+        mbCalendar = mbCalendar || (eEpochNano > op.mType);
+        mbCallSite = mbCallSite || (eFile == op.mType) || (eFullFile == op.mType) || (eFunction == op.mType);
+        // Maximum size of the operation (the Channel name and the message are added by format())
+        switch (op.mType) {
+            case eYear:         mMaxSize += 4;                  break;
+            case eMilli:        mMaxSize += 3;                  break;
+            case eMicro:        mMaxSize += 6;                  break;
+            case eNano:         mMaxSize += 9;                  break;
+            case eEpochNano:
+            case eThread:
+            case eLine:         mMaxSize += 20 + op.mWidth;     break;
+            case eThreadName:   mMaxSize += 20;                 break;
+            case eLevel:        mMaxSize += 4 + op.mWidth;      break;
+            case eFile:
+            case eFullFile:
+            case eFunction:
+            case eChannel:
+            case eMessage:      mMaxSize += op.mWidth;          break;
+            default:            mMaxSize += 2;                  break;
+        }
+        mOps.push_back(op);
+    }
+}
+
+// Write a text padded to the minimum width of the operation
+char* Pattern::write(char* apOut, const Op& aOp, const char* apText, size_t aSize) {
+    const size_t padding = (aSize < aOp.mWidth) ? (aOp.mWidth - aSize) : 0;
+    if (!aOp.mbLeft) {
+        memset(apOut, ' ', padding);
+        apOut += padding;
+    }
+    memcpy(apOut, apText, aSize);
+    apOut += aSize;
+    if (aOp.mbLeft) {
+        memset(apOut, ' ', padding);
+        apOut += padding;
+    }
+    return apOut;
+}
+
+// Append the Log formatted by the pattern to the buffer
+void Pattern::format(std::string& aBuffer, const std::string& aChannelName, const Log& aLog) const {
+    // A default pattern is the header shared by all the outputs, followed by the message
+    if (std::string::npos != mHeaderOffset) {
+        size_t      headerSize;
+        const char* pHeader = aLog.getHeader(aChannelName, headerSize);
+        aBuffer.append(pHeader + mHeaderOffset, headerSize - mHeaderOffset);
+        aBuffer.append(aLog.getMessage(), aLog.getMessageSize());
+        return;
+    }
+
+    // Grow the buffer once to the maximum size of the line, then write the operations directly into it
+    const CallSite* pCallSite   = aLog.getCallSite();
+    size_t          maxSize     = mMaxSize + aChannelName.size() + aLog.getMessageSize();
+    if (mbCallSite && (nullptr != pCallSite)) {
+        for (std::vector<Op>::const_iterator iOp = mOps.begin(); iOp != mOps.end(); ++iOp) {
+            if ((eFile == iOp->mType) || (eFullFile == iOp->mType)) {
+                maxSize += strlen(pCallSite->getFile());
+            } else if (eFunction == iOp->mType) {
+                maxSize += strlen(pCallSite->getFunction());
+            }
+        }
+    }
+    const size_t    size = aBuffer.size();
+    aBuffer.resize(size + maxSize);
+    char* const     pBegin = &aBuffer[0];
+    char*           pOut = pBegin + size;
+
+    // Convert the timestamp of the Log to calendar fields only if printed
+    const DateTime& time = mbCalendar ? aLog.getTime() : sNoTime;
+    char            decimal[20];
+    char* const     pDecimalEnd = decimal + sizeof(decimal);
+    const char*     pDecimal;
+    const char*     pText;
+    const Op        threadNameOp = { eThreadName, true, Log::THREAD_NAME_SIZE, 0 };
+    for (std::vector<Op>::const_iterator iOp = mOps.begin(); iOp != mOps.end(); ++iOp) {
+        switch (iOp->mType) {
+            case eLiteral:
+                memcpy(pOut, mLiterals.data() + iOp->mOffset, iOp->mWidth);
+                pOut += iOp->mWidth;
+                break;
+            case eYear:     pOut = writeDigits(pOut, static_cast<unsigned int>(time.year), 4);            break;
+            case eMonth:    pOut = writeDigits(pOut, static_cast<unsigned int>(time.month), 2);           break;
+            case eDay:      pOut = writeDigits(pOut, static_cast<unsigned int>(time.day), 2);             break;
+            case eHour:     pOut = writeDigits(pOut, static_cast<unsigned int>(time.hour), 2);            break;
+            case eMinute:   pOut = writeDigits(pOut, static_cast<unsigned int>(time.minute), 2);          break;
+            case eSecond:   pOut = writeDigits(pOut, static_cast<unsigned int>(time.second), 2);          break;
+            case eMilli:    pOut = writeDigits(pOut, static_cast<unsigned int>(time.ns) / 1000000, 3);    break;
+            case eMicro:    pOut = writeDigits(pOut, static_cast<unsigned int>(time.ns) / 1000, 6);       break;
+            case eNano:     pOut = writeDigits(pOut, static_cast<unsigned int>(time.ns), 9);              break;
+            case eEpochNano:
+                pDecimal = Stream::toDecimal(static_cast<unsigned long long>(aLog.getEpochNano()), pDecimalEnd);
+                pOut = write(pOut, *iOp, pDecimal, static_cast<size_t>(pDecimalEnd - pDecimal));
+                break;
+            case eThread:
+                pDecimal = Stream::toDecimal(aLog.getThreadId(), pDecimalEnd);
+                pOut = write(pOut, *iOp, pDecimal, static_cast<size_t>(pDecimalEnd - pDecimal));
+                break;
+            case eThreadName:
+                // The name is already padded: only the id has to be
+                pText = aLog.getThreadName();
+                if (nullptr != pText) {
+                    memcpy(pOut, pText, Log::THREAD_NAME_SIZE);
+                    pOut += Log::THREAD_NAME_SIZE;
+                } else {
+                    pDecimal = Stream::toDecimal(aLog.getThreadId(), pDecimalEnd);
+                    pOut = write(pOut, threadNameOp, pDecimal, static_cast<size_t>(pDecimalEnd - pDecimal));
+                }
+                break;
+            case eFile:
+                pText = (nullptr != pCallSite) ? pCallSite->getBaseName() : "";
+                pOut = write(pOut, *iOp, pText, strlen(pText));
+                break;
+            case eFullFile:
+                pText = (nullptr != pCallSite) ? pCallSite->getFile() : "";
+                pOut = write(pOut, *iOp, pText, strlen(pText));
+                break;
+            case eLine:
+                pDecimal = (nullptr != pCallSite) ? Stream::toDecimal(static_cast<unsigned long long>(
+                                                        pCallSite->getLine()), pDecimalEnd) : pDecimalEnd;
+                pOut = write(pOut, *iOp, pDecimal, static_cast<size_t>(pDecimalEnd - pDecimal));
+                break;
+            case eFunction:
+                pText = (nullptr != pCallSite) ? pCallSite->getFunction() : "";
+                pOut = write(pOut, *iOp, pText, strlen(pText));
+                break;
+            case eChannel:  pOut = write(pOut, *iOp, aChannelName.data(), aChannelName.size());           break;
+            case eLevel:    pOut = write(pOut, *iOp, Log::toString(aLog.getSeverity()), 4);               break;
+            case eMessage:  pOut = write(pOut, *iOp, aLog.getMessage(), aLog.getMessageSize());           break;
+        }
+    }
+    aBuffer.resize(static_cast<size_t>(pOut - pBegin));
+}
+
+
+} // namespace Log
@@ -0,0 +1,28 @@
+/**
+ * @file    StaticLogger.cpp
+ * @ingroup LoggerCpp
+ * @brief   A Logger declared as a constant, looking its Channel up only once
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <LoggerCpp/StaticLogger.h>
+#include <LoggerCpp/Manager.h>
+
+
+namespace Log {
+
+
+// Look the Channel up in the table of the Manager, and keep its pointer
+const Channel::Ptr* StaticLogger::lookup(void) const {
+    // Threads racing here get the same element of the table, never freed
+    const Channel::Ptr* pChannelPtr = &Manager::get(mpChannelName);
+    mpChannelPtr.store(pChannelPtr, std::memory_order_release);
+    return pChannelPtr;
+}
+
+
+} // namespace Log
@@ -0,0 +1,330 @@
+/**
+ * @file    Stream.cpp
+ * @ingroup LoggerCpp
+ * @brief   A reusable output string stream, recycled by each thread to format Log objects without allocation
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <LoggerCpp/Stream.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+
+namespace Log {
+
+
+/**
+ * @brief Pool of Stream objects owned by a thread
+ *
+ * More than one Stream is needed when a Log is built while another one is still alive in the same thread,
+ * typically when a value inserted into a Log is itself logging.
+ */
+class StreamPool {
+public:
+    /// @brief Constructor : reserve room for a few nested Log
+    StreamPool(void) {
+        mFreeList.reserve(4);
+    }
+
+    /// @brief Destructor : delete the Stream objects of the thread
+    ~StreamPool(void) {
+        std::vector<Stream*>::iterator iStream;
+        for (iStream  = mFreeList.begin();
+             iStream != mFreeList.end();
+             ++iStream) {
+            delete (*iStream);
+        }
+    }
+
+    /// @brief Free Stream objects of the thread
+    std::vector<Stream*> mFreeList;
+};
+
+/// Pool of Stream objects of the current thread
+static thread_local StreamPool sStreamPool;
+
+/// Pairs of decimal digits, to convert integers two digits at a time
+static const char sDigits[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/// Powers of ten, up to 10^18
+static const unsigned long long sPowers10[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+    10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+    1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL
+};
+
+/// Powers of ten as doubles, up to 10^9, to scale the values with decimals (all exact)
+static const double sScales10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+
+/**
+ * @brief Convert an unsigned integer to decimal with the given number of decimals ("0.05" for 5 with 2 decimals)
+ *
+ * @param[in] aValue    Value to convert, scaled by 10^aDecimals
+ * @param[in] aDecimals Number of decimals
+ * @param[in] apEnd     End of the buffer
+ *
+ * @return Beginning of the converted characters
+ */
+static char* toDecimals(unsigned long long aValue, int aDecimals, char* apEnd) {
+    for (int decimal = 0; decimal < aDecimals; ++decimal) {
+        *--apEnd = static_cast<char>('0' + (aValue % 10));
+        aValue /= 10;
+    }
+    if (0 < aDecimals) {
+        *--apEnd = '.';
+    }
+    return Stream::toDecimal(aValue, apEnd);
+}
+
+
+// Constructor : empty stream
+Stream::Stream(void) :
+    std::ostream(nullptr) {
+    rdbuf(&mBuffer);
+    mFlags = flags();
+    mFields.reserve(256);
+    mArgs.reserve(256);
+}
+
+// Destructor
+Stream::~Stream(void) {
+}
+
+// Take a Stream from the pool of the current thread
+Stream* Stream::acquire(void) {
+    Stream* pStream;
+    if (sStreamPool.mFreeList.empty()) {
+        pStream = new Stream();
+    } else {
+        pStream = sStreamPool.mFreeList.back();
+        sStreamPool.mFreeList.pop_back();
+    }
+    return pStream;
+}
+
+// Give back a Stream to the pool of the current thread
+void Stream::release(Stream* apStream) {
+    apStream->reset();
+    sStreamPool.mFreeList.push_back(apStream);
+}
+
+// Clear the content, the fields and the arguments, and reset the formatting state to their default
+void Stream::reset(void) {
+    mBuffer.clear();
+    mFields.clear();
+    mArgs.clear();
+    clear();
+    flags(mFlags);
+    width(0);
+    precision(6);
+    fill(' ');
+}
+
+// Append a character repeated the given number of times
+void Stream::append(size_t aCount, char aChar) {
+    char chars[64];
+    memset(chars, aChar, (aCount < sizeof(chars)) ? aCount : sizeof(chars));
+    while (aCount > 0) {
+        const size_t size = (aCount < sizeof(chars)) ? aCount : sizeof(chars);
+        append(chars, size);
+        aCount -= size;
+    }
+}
+
+// Append an integer in decimal, converted by hand
+void Stream::appendInteger(unsigned long long aValue, bool abNegative) {
+    char    buffer[24];  // 20 digits and a sign
+    char*   pEnd    = buffer + sizeof(buffer);
+    char*   pBegin  = toDecimal(aValue, pEnd);
+    if (abNegative) {
+        *--pBegin = '-';
+    }
+    append(pBegin, static_cast<size_t>(pEnd - pBegin));
+}
+
+// Append a floating point value with the precision of the stream (as the std::ostream does in its default state)
+void Stream::appendDouble(double aValue) {
+    char            buffer[DOUBLE_CHARS];
+    const size_t    size = toGeneral(buffer, aValue, static_cast<int>(precision()));
+    if (0 < size) {
+        append(buffer, size);
+    } else {
+        // Huge precision
+        *this << aValue;
+    }
+}
+
+// Convert a floating point value as "%.*g" does
+size_t Stream::toGeneral(char* apBuffer, double aValue, int aPrecision) {
+    const int       digits      = (0 < aPrecision) ? aPrecision : 1;
+    const double    absolute    = std::fabs(aValue);
+    char            buffer[DOUBLE_CHARS];
+    char* const     pEnd        = buffer + sizeof(buffer);
+    char*           pBegin      = nullptr;
+
+    if ((digits <= 18) && (absolute < 1e18)) {
+        const unsigned long long integer = static_cast<unsigned long long>(absolute);
+        if ((static_cast<double>(integer) == absolute) && (integer < sPowers10[digits])) {
+            // An integral value with no more digits than the precision is written as an integer
+            pBegin = toDecimal(integer, pEnd);
+        } else if ((digits <= 15) && (absolute >= 1e-4) && (absolute < static_cast<double>(sPowers10[digits]))) {
+            // Without exponent, the fewest decimals reading back to the value are the ones of "%g"
+            // if they make no more significant digits than the precision (up to 15, above which "%g" can show
+            // the binary rounding error): they are found as an integer scaled by a power of ten, like Fields::toChars()
+            for (int decimals = 1; decimals < 10; ++decimals) {
+                const double scaled = absolute * sScales10[decimals];
+                if (scaled >= 9007199254740992.0) {  // 2^53
+                    break;
+                }
+                const unsigned long long scaledInteger = static_cast<unsigned long long>(scaled + 0.5);
+                if (static_cast<double>(scaledInteger) / sScales10[decimals] == absolute) {
+                    if (scaledInteger < sPowers10[digits]) {
+                        pBegin = toDecimals(scaledInteger, decimals, pEnd);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    if (nullptr == pBegin) {
+        const int size = snprintf(apBuffer, DOUBLE_CHARS, "%.*g", aPrecision, aValue);
+        return ((0 <= size) && (size < static_cast<int>(DOUBLE_CHARS))) ? static_cast<size_t>(size) : 0;
+    }
+    if (std::signbit(aValue)) {
+        *--pBegin = '-';  // including -0.0, written "-0"
+    }
+    memcpy(apBuffer, pBegin, static_cast<size_t>(pEnd - pBegin));
+    return static_cast<size_t>(pEnd - pBegin);
+}
+
+// Convert a floating point value as "%.*f" does
+size_t Stream::toFixed(char* apBuffer, double aValue, int aPrecision) {
+    if ((0 <= aPrecision) && (aPrecision < 10)) {
+        const double scaled = std::fabs(aValue) * sScales10[aPrecision];
+        // Below 2^40, the rounding error of the scaling is below 2^-13: far from the margin kept around the ties,
+        // which are left to snprintf() (rounding the exact binary value)
+        if (scaled < 1099511627776.0) {
+            unsigned long long  integer     = static_cast<unsigned long long>(scaled);
+            const double        fraction    = scaled - static_cast<double>(integer);
+            if ((fraction < 0.499) || (fraction > 0.501)) {
+                if (fraction > 0.5) {
+                    ++integer;
+                }
+                char        buffer[DOUBLE_CHARS];
+                char* const pEnd    = buffer + sizeof(buffer);
+                char*       pBegin  = toDecimals(integer, aPrecision, pEnd);
+                if (std::signbit(aValue)) {
+                    *--pBegin = '-';  // including the negative values rounded to zero, like "%f"
+                }
+                memcpy(apBuffer, pBegin, static_cast<size_t>(pEnd - pBegin));
+                return static_cast<size_t>(pEnd - pBegin);
+            }
+        }
+    }
+
+    const int size = snprintf(apBuffer, DOUBLE_CHARS, "%.*f", aPrecision, aValue);
+    return ((0 <= size) && (size < static_cast<int>(DOUBLE_CHARS))) ? static_cast<size_t>(size) : 0;
+}
+
+// Append a pointer in hexadecimal
+void Stream::appendPointer(const void* apValue) {
+    uintptr_t   value = reinterpret_cast<uintptr_t>(apValue);
+    char    buffer[24];  // 16 digits and the "0x" prefix
+    char*   pEnd    = buffer + sizeof(buffer);
+    char*   pBegin  = pEnd;
+    do {
+        *--pBegin = "0123456789abcdef"[value & 0xF];
+        value >>= 4;
+    } while (0 != value);
+    if (nullptr != apValue) {
+        *--pBegin = 'x';
+        *--pBegin = '0';
+    }
+    append(pBegin, static_cast<size_t>(pEnd - pBegin));
+}
+
+// Convert an unsigned integer to decimal, two digits at a time
+char* Stream::toDecimal(unsigned long long aValue, char* apEnd) {
+    while (aValue >= 100) {
+        const size_t idx = static_cast<size_t>(aValue % 100) * 2;
+        aValue /= 100;
+        *--apEnd = sDigits[idx + 1];
+        *--apEnd = sDigits[idx];
+    }
+    if (aValue >= 10) {
+        const size_t idx = static_cast<size_t>(aValue) * 2;
+        *--apEnd = sDigits[idx + 1];
+        *--apEnd = sDigits[idx];
+    } else {
+        *--apEnd = static_cast<char>('0' + aValue);
+    }
+    return apEnd;
+}
+
+// Constructor : allocate a first buffer
+Stream::Buffer::Buffer(void) {
+    reserve(256);
+}
+
+// Clear the content, keeping the allocated memory
+void Stream::Buffer::clear(void) {
+    setp(&mData[0], &mData[0] + mData.size() - 1);
+}
+
+// Grow the buffer to make room for one more character
+Stream::Buffer::int_type Stream::Buffer::overflow(int_type aChar) {
+    if (traits_type::eq_int_type(aChar, traits_type::eof())) {
+        return traits_type::not_eof(aChar);
+    }
+    reserve(size() + 1);
+    *pptr() = traits_type::to_char_type(aChar);
+    pbump(1);
+    return aChar;
+}
+
+// Write a sequence of characters, growing the buffer at once if needed
+std::streamsize Stream::Buffer::xsputn(const char_type* apData, std::streamsize aSize) {
+    const size_t size = static_cast<size_t>(aSize);
+    if (static_cast<size_t>(epptr() - pptr()) < size) {
+        reserve(this->size() + size);
+    }
+    memcpy(pptr(), apData, size);
+    pbump(static_cast<int>(aSize));
+    return aSize;
+}
+
+// Grow the buffer so that it can hold at least the requested number of characters
+void Stream::Buffer::reserve(size_t aSize) {
+    const size_t used       = mData.empty() ? 0 : size();
+    size_t       capacity   = mData.empty() ? 0 : mData.size() - 1;
+    if (capacity < aSize) {
+        while (capacity < aSize) {
+            capacity = (0 == capacity) ? aSize : capacity * 2;
+        }
+        mData.resize(capacity + 1);  // room for the null terminator
+        setp(&mData[0], &mData[0] + capacity);
+        pbump(static_cast<int>(used));
+    }
+}
+
+
+} // namespace Log
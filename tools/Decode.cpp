@@ -0,0 +1,362 @@
+/**
+ * @file    Decode.cpp
+ * @brief   loggercpp-decode : convert OutputBinary files back into the text of the OutputFile
+ *
+ * Copyright (c) 2013-2018 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <LoggerCpp/OutputBinary.h>
+#include <LoggerCpp/Fields.h>
+#include <LoggerCpp/Format.h>
+#include <LoggerCpp/Log.h>
+#include <LoggerCpp/Stream.h>
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+
+/**
+ * @brief Decoder of one OutputBinary file, writing its Log as lines of text
+ */
+class Decoder {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param[in] abUtc         Force the dates to UTC, whatever the flag of the file header
+     * @param[in] abLocation    Print the source location ("file:line") of the Log produced by a LOG_xxx() macro
+     */
+    Decoder(bool abUtc, bool abLocation) :
+        mbForceUtc(abUtc),
+        mbUtc(abUtc),
+        mbLocation(abLocation),
+        mLastTime(0),
+        mpData(nullptr),
+        mpEnd(nullptr) {
+    }
+
+    /**
+     * @brief Decode a whole file to the standard output
+     *
+     * @param[in] apFilename    Name of the binary log file
+     *
+     * @return true on success, false if the file can not be read or is corrupted (an error is printed)
+     */
+    bool decode(const char* apFilename) {
+        if (!read(apFilename)) {
+            fprintf(stderr, "loggercpp-decode: can not read \"%s\"\n", apFilename);
+            return false;
+        }
+        if (!magic()) {
+            fprintf(stderr, "loggercpp-decode: \"%s\" is not a LoggerCpp binary file\n", apFilename);
+            return false;
+        }
+        while (mpData < mpEnd) {
+            if (!record()) {
+                fprintf(stderr, "loggercpp-decode: \"%s\" truncated or corrupted at offset %lu\n",
+                        apFilename, static_cast<unsigned long>(mpData - &mFile[0]));
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    /// @brief Read the whole file in memory
+    bool read(const char* apFilename) {
+        FILE* pFile = fopen(apFilename, "rb");
+        if (nullptr == pFile) {
+            return false;
+        }
+        mFile.clear();
+        char    buffer[65536];
+        size_t  size;
+        while (0 < (size = fread(buffer, 1, sizeof(buffer), pFile))) {
+            mFile.insert(mFile.end(), buffer, buffer + size);
+        }
+        const bool bError = (0 != ferror(pFile));
+        fclose(pFile);
+        mFile.push_back('\0');  // so that &mFile[0] is valid even for an empty file
+        mpData  = &mFile[0];
+        mpEnd   = mpData + mFile.size() - 1;
+        return !bError;
+    }
+
+    /// @brief Check the magic string at the current position, accepting the previous versions of the format
+    bool magic(void) const {
+        const size_t size = sizeof(Log::OutputBinary::MAGIC) - 1;
+        return (mpEnd - mpData > static_cast<ptrdiff_t>(size))
+            && (0 == memcmp(mpData, Log::OutputBinary::MAGIC, size))
+            && (1 <= mpData[size]) && (Log::OutputBinary::MAGIC[size] >= mpData[size]);
+    }
+
+    /// @brief Read an unsigned LEB128 varint
+    bool varint(unsigned long long& aValue) {
+        aValue = 0;
+        for (unsigned int shift = 0; (mpData < mpEnd) && (shift < 64); shift += 7) {
+            const unsigned char byte = static_cast<unsigned char>(*mpData++);
+            aValue |= static_cast<unsigned long long>(byte & 0x7F) << shift;
+            if (0 == (byte & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// @brief Read a string of the given size
+    bool string(unsigned long long aSize, const char*& apString) {
+        if (static_cast<unsigned long long>(mpEnd - mpData) < aSize) {
+            return false;
+        }
+        apString = mpData;
+        mpData += aSize;
+        return true;
+    }
+
+    /// @brief Decode one record
+    bool record(void) {
+        const unsigned char tag = static_cast<unsigned char>(*mpData);
+        bool bValid = false;
+        if (Log::OutputBinary::eRecordHeader == tag) {
+            bValid = header();
+        } else if (Log::OutputBinary::eRecordChannel == tag) {
+            ++mpData;
+            bValid = channel();
+        } else if (Log::OutputBinary::eRecordCallSite == tag) {
+            ++mpData;
+            bValid = callSite();
+        } else if (Log::OutputBinary::eRecordFormat == tag) {
+            ++mpData;
+            bValid = format();
+        } else if (tag <= Log::OutputBinary::eRecordLog + Log::Log::eCritic) {
+            ++mpData;
+            bValid = log(static_cast<Log::Log::Level>(tag - Log::OutputBinary::eRecordLog), false, false);
+        } else if ((Log::OutputBinary::eRecordLogAt <= tag)
+                && (tag <= Log::OutputBinary::eRecordLogAt + Log::Log::eCritic)) {
+            ++mpData;
+            bValid = log(static_cast<Log::Log::Level>(tag - Log::OutputBinary::eRecordLogAt), true, false);
+        } else if ((Log::OutputBinary::eRecordLogArgs <= tag)
+                && (tag <= Log::OutputBinary::eRecordLogArgs + Log::Log::eCritic)) {
+            ++mpData;
+            bValid = log(static_cast<Log::Log::Level>(tag - Log::OutputBinary::eRecordLogArgs), true, true);
+        }
+        return bValid;
+    }
+
+    /// @brief Decode a file header, resetting the Channel names, the CallSite locations and formats, and the time base
+    bool header(void) {
+        if ((mpEnd - mpData < static_cast<ptrdiff_t>(sizeof(Log::OutputBinary::MAGIC) + 1)) || !magic()) {
+            return false;
+        }
+        mpData += sizeof(Log::OutputBinary::MAGIC);
+        mbUtc = mbForceUtc || (0 != (*mpData & Log::OutputBinary::eFlagUtc));
+        ++mpData;
+        mChannels.clear();
+        mCallSites.clear();
+        mFormats.clear();
+        mLastTime = 0;
+        return true;
+    }
+
+    /// @brief Decode a Channel definition
+    bool channel(void) {
+        unsigned long long  id;
+        unsigned long long  size;
+        const char*         pName;
+        if (!varint(id) || !varint(size) || !string(size, pName) || (id != mChannels.size())) {
+            return false;
+        }
+        mChannels.push_back(std::string(pName, static_cast<size_t>(size)));
+        return true;
+    }
+
+    /// @brief Decode a CallSite definition, keeping its location as "file:line"
+    bool callSite(void) {
+        unsigned long long  id;
+        unsigned long long  line;
+        unsigned long long  size;
+        const char*         pFile;
+        const char*         pFunction;
+        if (!varint(id) || !varint(line) || !varint(size) || !string(size, pFile) || (id != mCallSites.size())) {
+            return false;
+        }
+        std::string location(pFile, static_cast<size_t>(size));
+        if (!varint(size) || !string(size, pFunction)) {
+            return false;
+        }
+        const size_t separator = location.find_last_of("/\\");
+        if (std::string::npos != separator) {
+            location.erase(0, separator + 1);
+        }
+        char number[24];
+        snprintf(number, sizeof(number), ":%llu", line);
+        mCallSites.push_back(location + number);
+        mFormats.push_back(std::string());
+        return true;
+    }
+
+    /// @brief Decode the format string of a CallSite
+    bool format(void) {
+        unsigned long long  id;
+        unsigned long long  size;
+        const char*         pFormat;
+        if (!varint(id) || !varint(size) || !string(size, pFormat) || (id >= mFormats.size())) {
+            return false;
+        }
+        mFormats[static_cast<size_t>(id)].assign(pFormat, static_cast<size_t>(size));
+        return true;
+    }
+
+    /**
+     * @brief Format the message of a Log from the format string of its CallSite and its encoded arguments
+     *
+     * @param[in] aCallSiteId   Id of the CallSite
+     * @param[in] apArgs        Arguments, encoded as Fields without key
+     * @param[in] aSize         Size of the encoded arguments
+     *
+     * @return false if the arguments are corrupted
+     */
+    bool formatArgs(unsigned long long aCallSiteId, const char* apArgs, unsigned long long aSize) {
+        const char*                     pEnd = apArgs + aSize;
+        std::vector<Log::Fields::Field> fields;
+        Log::Fields::Field              field;
+        while (Log::Fields::next(apArgs, pEnd, field)) {
+            fields.push_back(field);
+        }
+        if (apArgs != pEnd) {
+            return false;
+        }
+
+        // Type-erased references to the decoded values, formatted like the Log was (strings are not null-terminated)
+        std::vector<std::string>        strings(fields.size());
+        std::vector<Log::Format::Arg>   args;
+        for (size_t idx = 0; idx < fields.size(); ++idx) {
+            switch (fields[idx].type) {
+            case Log::Fields::eBool:    args.push_back(Log::Format::Arg(fields[idx].b)); break;
+            case Log::Fields::eInt:     args.push_back(Log::Format::Arg(fields[idx].i)); break;
+            case Log::Fields::eUint:    args.push_back(Log::Format::Arg(fields[idx].u)); break;
+            case Log::Fields::eDouble:  args.push_back(Log::Format::Arg(fields[idx].d)); break;
+            case Log::Fields::eString:
+            default:
+                strings[idx].assign(fields[idx].pString, fields[idx].stringSize);
+                args.push_back(Log::Format::Arg(strings[idx]));
+                break;
+            }
+        }
+        // (a const pointer, not to be taken for a variadic argument by the template overload of write())
+        const Log::Format::Arg* pArgs = args.empty() ? nullptr : &args[0];
+        mMessage.reset();
+        Log::Format::write(mMessage, mFormats[static_cast<size_t>(aCallSiteId)].c_str(), pArgs, args.size());
+        return true;
+    }
+
+    /**
+     * @brief Decode a Log and print it like the OutputFile does (preceded by its CallSite location if asked for)
+     *
+     * @param[in] aLevel        Level of the Log
+     * @param[in] abCallSite    The Log has a CallSite
+     * @param[in] abArgs        The Log stores the arguments of the format string of its CallSite instead of a message
+     *
+     * @return false if the record is truncated or corrupted
+     */
+    bool log(Log::Log::Level aLevel, bool abCallSite, bool abArgs) {
+        unsigned long long  id;
+        unsigned long long  callSiteId = 0;
+        unsigned long long  zigzag;
+        unsigned long long  size;
+        const char*         pMessage;
+        if (!varint(id) || (abCallSite && (!varint(callSiteId) || (callSiteId >= mCallSites.size())))
+         || !varint(zigzag) || !varint(size) || !string(size, pMessage) || (id >= mChannels.size())) {
+            return false;
+        }
+        if (abArgs) {
+            if (!formatArgs(callSiteId, pMessage, size)) {
+                return false;
+            }
+            pMessage    = mMessage.c_str();
+            size        = mMessage.size();
+        }
+        const long long delta = static_cast<long long>(zigzag >> 1) ^ -static_cast<long long>(zigzag & 1);
+        mLastTime += delta;
+
+        const time_t    seconds = static_cast<time_t>(mLastTime / 1000000000LL);
+        const unsigned  ms      = static_cast<unsigned>((mLastTime % 1000000000LL) / 1000000);
+        struct tm       timeinfo;
+#ifdef WIN32
+        if (mbUtc) {
+            gmtime_s(&timeinfo, &seconds);
+        } else {
+            localtime_s(&timeinfo, &seconds);
+        }
+#else
+        if (mbUtc) {
+            gmtime_r(&seconds, &timeinfo);
+        } else {
+            localtime_r(&seconds, &timeinfo);
+        }
+#endif
+        char text[20];
+        snprintf(text, sizeof(text), "%.4u-%.2u-%.2u %.2u:%.2u:%.2u",
+                 timeinfo.tm_year + 1900, timeinfo.tm_mon + 1, timeinfo.tm_mday,
+                 timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
+
+        printf("%s.%.3u  %-12s %s ", text, ms, mChannels[static_cast<size_t>(id)].c_str(), Log::Log::toString(aLevel));
+        if (mbLocation && abCallSite) {
+            printf("%s ", mCallSites[static_cast<size_t>(callSiteId)].c_str());
+        }
+        fwrite(pMessage, 1, static_cast<size_t>(size), stdout);
+        putchar('\n');
+        return true;
+    }
+
+private:
+    bool                        mbForceUtc; ///< Force the dates to UTC
+    bool                        mbUtc;      ///< Decode the dates of the current file in UTC
+    bool                        mbLocation; ///< Print the CallSite location of the Log
+    long long                   mLastTime;  ///< Time of the previous Log in nanoseconds since the Epoch
+    std::vector<std::string>    mChannels;  ///< Names of the Channel defined in the current file, by id
+    std::vector<std::string>    mCallSites; ///< Locations "file:line" of the CallSite defined in the current file, by id
+    std::vector<std::string>    mFormats;   ///< Format strings of the CallSite defined in the current file, by id
+    Log::Stream                 mMessage;   ///< Message formatted from the arguments of a Log
+    std::vector<char>           mFile;      ///< Content of the file
+    const char*                 mpData;     ///< Current position in the file
+    const char*                 mpEnd;      ///< End of the file
+};
+
+
+/**
+ * @brief Decode the binary log files given on the command line, in order, to the standard output
+ */
+int main(int argc, char* argv[]) {
+    bool    bUtc        = false;
+    bool    bLocation   = false;
+    int     first       = 1;
+    for (; (first < argc) && ('-' == argv[first][0]); ++first) {
+        if (0 == strcmp(argv[first], "--utc")) {
+            bUtc = true;
+        } else if (0 == strcmp(argv[first], "--location")) {
+            bLocation = true;
+        } else {
+            break;
+        }
+    }
+    if (first >= argc) {
+        fprintf(stderr, "usage: loggercpp-decode [--utc] [--location] log.old.bin log.bin ...\n");
+        return 2;
+    }
+
+    int ret = 0;
+    for (int idx = first; idx < argc; ++idx) {
+        Decoder decoder(bUtc, bLocation);
+        if (!decoder.decode(argv[idx])) {
+            ret = 1;
+        }
+    }
+    return ret;
+}